@@ -8,14 +8,22 @@ precision mediump float;
 
 uniform sampler2D texture;
 uniform vec4 color;
+// Per-draw modulation set by SpiritBatch::draw, see src/Type/SpriteColor.h
+uniform vec4 tint;
+uniform float flash;
+uniform vec4 multiply;
 
 varying vec2 v_texcoord;
 
 //! [0]
 void main()
 {
+    vec4 texel = texture2D(texture, v_texcoord);
+    // Pull the colour towards the tint, then towards white, keeping the alpha of the texture
+    vec3 rgb = mix(texel.rgb, tint.rgb, tint.a);
+    rgb = mix(rgb, vec3(1.0), flash);
     // Set fragment color from texture
-    gl_FragColor = texture2D(texture, v_texcoord)*color;
+    gl_FragColor = vec4(rgb, texel.a) * color * multiply;
 }
 //! [0]
 
@@ -0,0 +1,192 @@
+//
+// Created by root on 7/10/25.
+//
+// Headless benchmark of the render path: queue update, ordering, snapshot extraction and rasterisation
+// through SoftwareRenderer, plus a pixel check of one known sprite
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <QColor>
+
+#include "../src/Components/Drawable.h"
+#include "../src/Components/Transform.h"
+#include "../src/Render/RenderBackend.h"
+#include "../src/Render/RenderQueue.h"
+#include "../src/Render/SoftwareRenderer.h"
+
+namespace
+{
+    double millisecondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Translucent disc over a hue gradient, so blending and sampling both show up in the output
+    QImage makeImage(const int size, const int seed)
+    {
+        QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+        const float radius = static_cast<float>(size) / 2;
+        for (int y = 0; y < size; y++)
+        {
+            auto* row = reinterpret_cast<QRgb*>(image.scanLine(y));
+            for (int x = 0; x < size; x++)
+            {
+                const float dx = static_cast<float>(x) + 0.5f - radius;
+                const float dy = static_cast<float>(y) + 0.5f - radius;
+                const bool inside = dx * dx + dy * dy < radius * radius;
+                const QColor color = QColor::fromHsv((seed * 47 + x * 2) % 360, 200, 255, inside ? 255 : 96);
+                row[x] = qPremultiply(color.rgba());
+            }
+        }
+        return image;
+    }
+
+    // One opaque red sprite filling the middle of the view must leave a red centre pixel
+    bool pixelCheck()
+    {
+        QImage image(4, 4, QImage::Format_ARGB32_Premultiplied);
+        image.fill(0xFFFF0000);
+        Texture texture{.image = image, .config = {.scale = 1}};
+        RenderSnapshot snapshot;
+        snapshot.textures.push_back(&texture);
+        snapshot.transforms.push_back(Transform::fromTranslation({0, 0, 0}));
+        snapshot.colors.emplace_back();
+        std::vector<float> matrices;
+        SoftwareRenderer renderer(64, 64, 1, 1);
+        renderer.begin(0xFF000000);
+        drawSnapshot(renderer, snapshot, matrices);
+        renderer.end();
+        return renderer.image().pixel(32, 32) == 0xFFFF0000 && renderer.image().pixel(2, 2) == 0xFF000000;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = 20000;
+    int width = 1280;
+    int height = 720;
+    int threads = 4;
+    const char* output = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else
+        {
+            count = std::strtoul(argv[i], nullptr, 10);
+        }
+    }
+    constexpr int frames = 20;
+    constexpr int textureCount = 32;
+    constexpr float zoom = 0.05f;
+
+    if (!pixelCheck())
+    {
+        std::printf("pixel check failed\n");
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Texture>> textures;
+    for (int i = 0; i < textureCount; i++)
+    {
+        textures.push_back(std::make_unique<Texture>(Texture{.image = makeImage(32 + i % 4 * 32, i),
+                                                             .config = {.scale = 1.0f + static_cast<float>(i % 3)}}));
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> x(-35, 35);
+    std::uniform_real_distribution<float> y(-20, 20);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::uniform_int_distribution<int> pick(0, textureCount - 1);
+    entt::registry registry;
+    RenderQueue queue(registry);
+    std::vector<entt::entity> entities(count);
+    for (auto& entity : entities)
+    {
+        entity = registry.create();
+        Transform transform = Transform::fromTranslation({x(generator), y(generator), unit(generator) * 10});
+        const float angle = unit(generator) * 6.2831853f;
+        transform.rotation = {std::cos(angle), std::sin(angle)};
+        registry.emplace<Transform>(entity, transform);
+        // Every eighth sprite is tinted, to keep the colour path in the numbers
+        const SpriteColor color = (entities.size() - static_cast<size_t>(&entity - entities.data())) % 8 == 0
+                                      ? SpriteColor{.tint = 0x80FF4000}
+                                      : SpriteColor{};
+        registry.emplace<Drawable>(entity, Drawable{
+                                       .texture = TextureHandle::unowned(textures[pick(generator)].get()),
+                                       .color = color
+                                   });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    queue.update();
+    const double fullSort = millisecondsSince(start);
+
+    // Move a tenth of the sprites every frame, like a busy scene would
+    double incremental = 0;
+    double extraction = 0;
+    double rasterise = 0;
+    std::vector<entt::entity> visible;
+    std::vector<float> matrices;
+    RenderSnapshot snapshot;
+    SoftwareRenderer renderer(width, height, zoom, threads);
+    for (int frame = 0; frame < frames; frame++)
+    {
+        for (size_t i = frame; i < entities.size(); i += 10)
+        {
+            registry.patch<Transform>(entities[i], [&](Transform& transform)
+            {
+                transform.z = unit(generator) * 10;
+            });
+        }
+        start = std::chrono::steady_clock::now();
+        queue.update();
+        incremental += millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        visible = entities;
+        queue.order(visible);
+        snapshot.clear();
+        for (const auto entity : visible)
+        {
+            const auto& drawable = registry.get<Drawable>(entity);
+            snapshot.textures.push_back(drawable.texture.get());
+            snapshot.transforms.push_back(registry.get<Transform>(entity));
+            snapshot.colors.push_back(drawable.color);
+        }
+        extraction += millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        renderer.begin(0xFF202020);
+        drawSnapshot(renderer, snapshot, matrices);
+        renderer.end();
+        rasterise += millisecondsSince(start);
+    }
+
+    std::printf("%zu sprites, %d textures, %dx%d, %d threads, %d frames\n", count, textureCount, width, height,
+                threads, frames);
+    std::printf("queue full sort       %8.3f ms\n", fullSort);
+    std::printf("queue update          %8.3f ms/frame\n", incremental / frames);
+    std::printf("order + snapshot      %8.3f ms/frame\n", extraction / frames);
+    std::printf("draw + rasterise      %8.3f ms/frame  (%zu quads)\n", rasterise / frames, renderer.quadCount());
+    if (output && !renderer.image().save(output))
+    {
+        std::printf("could not write %s\n", output);
+        return 1;
+    }
+    return 0;
+}
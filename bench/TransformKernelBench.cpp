@@ -0,0 +1,84 @@
+//
+// Created by root on 7/10/25.
+//
+// Micro-benchmark of the transform to render matrix kernels against the scalar path
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../src/Render/TransformKernel.h"
+
+namespace
+{
+    template <typename Function>
+    double bestOf(const int runs, Function&& function)
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; run++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    constexpr int runs = 50;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-100, 100);
+    std::vector<Transform> transforms(count);
+    for (auto& transform : transforms)
+    {
+        const float angle = distribution(generator);
+        transform.position = {distribution(generator), distribution(generator)};
+        transform.rotation = {std::cos(angle), std::sin(angle)};
+        transform.scale = distribution(generator) < 0 ? -1.0f : 1.0f;
+        transform.z = distribution(generator);
+    }
+    std::vector<float> vectorised(count * TransformKernel::matrixSize);
+    std::vector<float> scalar(count * TransformKernel::matrixSize);
+    std::vector<Matrix> matrices(count);
+
+    const double perMatrix = bestOf(runs, [&]
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            matrices[i] = transforms[i].toMatrix();
+        }
+    });
+    const double scalarTime = bestOf(runs, [&]
+    {
+        TransformKernel::toMatricesScalar(transforms.data(), count, scalar.data());
+    });
+    const double vectorisedTime = bestOf(runs, [&]
+    {
+        TransformKernel::toMatrices(transforms.data(), count, vectorised.data());
+    });
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < vectorised.size(); i++)
+    {
+        mismatches += vectorised[i] != scalar[i];
+    }
+
+    const double bytes = static_cast<double>(count) * (sizeof(Transform) + TransformKernel::matrixSize * sizeof(float));
+    std::printf("%zu transforms, best of %d runs\n", count, runs);
+    std::printf("Transform::toMatrix   %8.2f ns/transform\n", perMatrix / count);
+    std::printf("scalar kernel         %8.2f ns/transform  %6.2f GB/s\n", scalarTime / count, bytes / scalarTime);
+    std::printf("%-6s kernel         %8.2f ns/transform  %6.2f GB/s\n", TransformKernel::implementation(),
+                vectorisedTime / count, bytes / vectorisedTime);
+    std::printf("mismatches against scalar: %zu\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
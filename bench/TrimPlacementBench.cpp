@@ -0,0 +1,109 @@
+//
+// Created by root on 7/10/25.
+//
+// Micro-benchmark of trimmed sprite placement, also checks that every corner of a trimmed quad drawn at its
+// placement lands inside the untrimmed quad, at the corner of the kept rect, whatever the rotation and mirroring
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../src/Components/Transform.h"
+#include "../src/Render/SpriteTrim.h"
+
+namespace
+{
+    template <typename Function>
+    double bestOf(const int runs, Function&& function)
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; run++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        return best;
+    }
+
+    // Same as placement() in src/Components/Drawable.h, without a TextureHandle
+    Transform place(const Transform& transform, const SpriteTrim::Trim& trim, const float height)
+    {
+        const QPointF offset = SpriteTrim::offset(trim, height);
+        return transform.translated({static_cast<float>(offset.x()), static_cast<float>(offset.y())});
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    constexpr int runs = 50;
+    // Sprite height in world units, the Texture::Config::scale of the untrimmed texture
+    constexpr float height = 2;
+    constexpr int canvasSize = 64;
+    constexpr float tolerance = 1e-3f;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-100, 100);
+    std::uniform_int_distribution<int> texel(0, canvasSize - 1);
+    std::vector<Transform> transforms(count);
+    std::vector<SpriteTrim::Trim> trims(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const float angle = distribution(generator);
+        transforms[i].position = {distribution(generator), distribution(generator)};
+        transforms[i].rotation = {std::cos(angle), std::sin(angle)};
+        transforms[i].scale = distribution(generator) < 0 ? -1.0f : 1.0f;
+        const int left = texel(generator);
+        const int top = texel(generator);
+        trims[i] = SpriteTrim::Trim{
+            .canvas = QSize(canvasSize, canvasSize),
+            .rect = QRect(QPoint(left, top), QPoint(std::max(left, texel(generator)), std::max(top, texel(generator))))
+        };
+    }
+    std::vector<Transform> placed(count);
+
+    const double time = bestOf(runs, [&]
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            placed[i] = place(transforms[i], trims[i], height);
+        }
+    });
+
+    size_t outside = 0;
+    const float unitsPerTexel = height / canvasSize;
+    const float half = canvasSize * unitsPerTexel / 2;
+    for (size_t i = 0; i < count; i++)
+    {
+        const QRect& rect = trims[i].rect;
+        const float halfWidth = rect.width() * unitsPerTexel / 2;
+        const float halfHeight = rect.height() * unitsPerTexel / 2;
+        const QMatrix4x4 drawn = placed[i].toMatrix();
+        const QMatrix4x4 canvas = transforms[i].toMatrix().inverted();
+        for (const float x : {-1.0f, 1.0f})
+        {
+            for (const float y : {-1.0f, 1.0f})
+            {
+                // Corner of the trimmed quad, back in the frame of the untrimmed one
+                const QVector3D corner = canvas.map(drawn.map(QVector3D(x * halfWidth, y * halfHeight, 0)));
+                // Where that corner of the kept rect sits on the canvas, y up like the quad
+                const float expectedX = ((x < 0 ? rect.left() : rect.right() + 1) - canvasSize / 2.0f) * unitsPerTexel;
+                const float expectedY = (canvasSize / 2.0f - (y < 0 ? rect.bottom() + 1 : rect.top())) * unitsPerTexel;
+                outside += std::abs(corner.x()) > half + tolerance || std::abs(corner.y()) > half + tolerance ||
+                    std::abs(corner.x() - expectedX) > tolerance || std::abs(corner.y() - expectedY) > tolerance;
+            }
+        }
+    }
+
+    std::printf("%zu trimmed sprites, best of %d runs\n", count, runs);
+    std::printf("placement             %8.2f ns/sprite\n", time / count);
+    std::printf("corners off their canvas: %zu\n", outside);
+    return outside == 0 ? 0 : 1;
+}
@@ -7,7 +7,7 @@
 
 #include <unordered_map>
 #include <vector>
-#include "Texture.h"
+#include "../Managers/TextureHandle.h"
 
 
 // Animation clip data structure
@@ -16,7 +16,7 @@ struct Clip
     float frameDuration = 0.16f; // Duration of each frame in seconds
     bool loop = true; // Whether the animation should loop
     int frameCount = 0;
-    std::vector<Texture*> frames;
+    std::vector<TextureHandle> frames;
 };
 
 // Animation component for entities
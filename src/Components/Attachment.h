@@ -5,6 +5,8 @@
 #ifndef ATTACHMENT_H
 #define ATTACHMENT_H
 #include "entt/entity/entity.hpp"
+// Weapon held by an entity. Nothing links it into the hierarchy, attach it with HierarchySystem::attach for its
+// Transform to follow the holder
 struct Weapon
 {
     entt::entity weaponEntity;
@@ -0,0 +1,29 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef CHUNK_H
+#define CHUNK_H
+#include <memory>
+#include <vector>
+
+#include "Texture.h"
+#include "entt/entity/entity.hpp"
+
+// A static sprite (TagStaticSprite) baked into a chunk, maintained by ChunkBakeSystem.
+// The tile keeps its Drawable, it is just no longer drawn on its own
+struct BakedTile
+{
+    entt::entity chunk = entt::null;
+};
+
+// Entity drawing many baked tiles as one sprite
+struct BakedChunk
+{
+    std::vector<entt::entity> tiles;
+    // Shared with the render snapshots still showing it, a re-bake swaps in a new texture
+    std::shared_ptr<Texture> texture;
+    bool dirty = true;
+};
+
+#endif //CHUNK_H
@@ -4,9 +4,29 @@
 
 #ifndef DRAWABLE_H
 #define DRAWABLE_H
-#include "Texture.h"
+#include <cstdint>
+
+#include "Transform.h"
+#include "../Managers/TextureHandle.h"
+#include "../Type/SpriteColor.h"
 
 struct Drawable {
-    Texture* texture = nullptr;
+    TextureHandle texture;
+    // Drawn above every lower layer whatever the depth, e.g. ui over the world
+    uint8_t layer = 0;
+    // Applied at draw time, so colour variants need no texture of their own
+    SpriteColor color;
 };
+
+// Where the texture of an entity at transform is drawn, a trimmed texture sits off the centre of its entity.
+// The offset is a point of the untrimmed quad, so it turns with the quad (bench/TrimPlacementBench.cpp checks it)
+inline Transform placement(const Drawable& drawable, const Transform& transform)
+{
+    const QPointF offset = drawable.texture.offset();
+    if (offset.isNull())
+    {
+        return transform;
+    }
+    return transform.translated({static_cast<float>(offset.x()), static_cast<float>(offset.y())});
+}
 #endif //DRAWABLE_H
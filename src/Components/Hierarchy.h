@@ -0,0 +1,30 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+#include <cstdint>
+
+#include "Transform.h"
+#include "entt/entity/entity.hpp"
+
+// Parent/child link, maintained by HierarchySystem, never edit the links by hand
+struct Hierarchy
+{
+    entt::entity parent = entt::null;
+    entt::entity firstChild = entt::null;
+    entt::entity nextSibling = entt::null;
+    entt::entity previousSibling = entt::null;
+    // Distance to the root, the storage is kept sorted by it so parents always come before their children
+    uint32_t depth = 0;
+    // Transform relative to the parent, the Transform of a child is the propagated world transform
+    Transform local;
+    // Last propagated world transform
+    Transform world;
+    // Tick of the last time world changed, children compare it with the current tick
+    uint32_t changed = 0;
+    bool dirty = true;
+};
+
+#endif //HIERARCHY_H
@@ -4,6 +4,7 @@
 
 #ifndef STATUSPLAYER_H
 #define STATUSPLAYER_H
+#include <cstdint>
 
 class PrefabProjectile;
 
@@ -28,4 +29,13 @@ struct StatusWeapon
     PrefabProjectile* ammoType;
 };
 
+// Active buffs as a bit set, bit i shows the i-th buff icon on the HUD
+struct StatusBuff
+{
+    // Just hit, set by HealthSystem while the target flashes
+    constexpr static uint32_t hurt = 1u << 0;
+
+    uint32_t active = 0;
+};
+
 #endif //STATUSPLAYER_H
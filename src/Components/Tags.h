@@ -12,4 +12,9 @@ struct TagBodyCreation
 struct TagBodyDestruction
 {
 };
+
+// Never moves nor animates, ChunkBakeSystem bakes it together with its neighbours
+struct TagStaticSprite
+{
+};
 #endif //TAGS_H
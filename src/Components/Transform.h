@@ -5,14 +5,113 @@
 #ifndef TRANSFORM_H
 #define TRANSFORM_H
 
+#include <cmath>
+
 #include "../Type/Matrix.h"
+#include "../Type/Vector.h"
+#include "box2d/math_functions.h"
 
+// Simulation side 2D transform, the 4x4 matrix is only built at render submission
 struct Transform {
-    Matrix matrix;
-    // In your Transform class or header
+    b2Vec2 position = {0, 0};
+    b2Rot rotation = {1, 0};
+    // Uniform scale, negative when the sprite is mirrored horizontally
+    float scale = 1;
+    // Depth, smaller is further away
+    float z = 0;
+
+    float flip() const
+    {
+        return scale < 0 ? -1.0f : 1.0f;
+    }
+
+    void setFlip(const float flip)
+    {
+        scale = std::copysign(scale, flip);
+    }
+
+    void updateTransform(const b2Transform& transform)
+    {
+        position = transform.p;
+        rotation = transform.q;
+    }
+
+    operator b2Transform() const
+    {
+        return b2Transform{position, rotation};
+    }
+
+    Vector getPosition() const
+    {
+        return Vector(position.x, position.y, z);
+    }
+
+    Vector getRotation() const
+    {
+        return Vector(rotation.c, rotation.s);
+    }
+
+    // Transform of a child placed at local relative to this one, in the frame toMatrix draws this one in: the
+    // child sits on the same spot of the quad whatever the rotation
+    Transform operator*(const Transform& local) const
+    {
+        const float scaleX = scale;
+        const float scaleY = std::abs(scale);
+        const b2Vec2 offset = {scaleX * local.position.x, scaleY * local.position.y};
+        // a mirrored parent mirrors the rotation of its children as well
+        const b2Rot localRotation = scale < 0
+                                        ? b2Rot{local.rotation.c, -local.rotation.s}
+                                        : local.rotation;
+        return Transform{
+            .position = {
+                position.x + rotation.c * offset.x + rotation.s * offset.y,
+                position.y - rotation.s * offset.x + rotation.c * offset.y
+            },
+            .rotation = {
+                rotation.c * localRotation.c - rotation.s * localRotation.s,
+                rotation.s * localRotation.c + rotation.c * localRotation.s
+            },
+            .scale = scale * local.scale,
+            .z = z + local.z
+        };
+    }
+
+    bool operator==(const Transform& other) const
+    {
+        return position.x == other.position.x && position.y == other.position.y &&
+            rotation.c == other.rotation.c && rotation.s == other.rotation.s &&
+            scale == other.scale && z == other.z;
+    }
+
+    // Render matrix, same layout the renderer has always been fed
+    Matrix toMatrix() const
+    {
+        const float scaleX = scale;
+        const float scaleY = std::abs(scale);
+        return QMatrix4x4{
+            scaleX * rotation.c, scaleY * rotation.s, 0, position.x,
+            -scaleX * rotation.s, scaleY * rotation.c, 0, position.y,
+            0, 0, 1, z,
+            0, 0, 0, 1
+        };
+    }
+
+    // Same transform moved to local, a point of the sprite quad
+    Transform translated(const b2Vec2 local) const
+    {
+        return *this * Transform{.position = local};
+    }
+
+    static Transform fromTranslation(const Vector translate)
+    {
+        return Transform{.position = {translate.x(), translate.y()}, .z = translate.z()};
+    }
 };
 
+static_assert(sizeof(Transform) == 24);
+
 inline std::ostream& operator<<(std::ostream& os,const Transform& transform )  {
-    return os<< "Transform{matrix: " <<transform.matrix<<"}";
+    return os << "Transform{position: " << transform.getPosition() << ", rotation: " << transform.getRotation()
+        << ", scale: " << transform.scale << "}";
 }
 #endif //TRANSFORM_H
@@ -4,42 +4,106 @@
 
 #include "Scene.h"
 
+#include <QDebug>
+#include <QScreen>
+
 #include "World.h"
 #include "../Components/Animator.h"
 #include "../Components/Drawable.h"
 #include "../Components/Transform.h"
-#include "../Events/KeyEvents.h"
 #include "../Managers/TextureManager.h"
+#include "../Render/RenderBackend.h"
+#include "../Render/SpiritBatchBackend.h"
 #include "../Systems/AnimationSystem.h"
+#include "../Type/Errors.h"
 
 void Scene::render(SpiritBatch& batch)
 {
-    auto& registry = World::getInstance().registry;
-    const auto view = registry.view<const Drawable, const Transform>();
-    view.each([&batch](
-        const Drawable& drawable,
-        const Transform& transform)
+    const float aspect = height() > 0 ? static_cast<float>(width()) / static_cast<float>(height()) : 1.0f;
+    simulation.setView(camera_zoom, aspect, static_cast<float>(height() * devicePixelRatio()));
+    const RenderSnapshot* snapshot = simulation.acquireSnapshot();
+    if (!snapshot)
+    {
+        return;
+    }
+
+    SpiritBatchBackend backend(batch);
+    RenderBackend* target = &backend;
+    if (capture)
+    {
+        capture->beginFrame(backend, snapshot->tick, camera_zoom, aspect);
+        target = capture.get();
+    }
+    drawSnapshot(*target, *snapshot, drawMatrices);
+    hud.update(snapshot->hud, size());
+    hud.draw(*target, camera_zoom);
+    if (capture)
+    {
+        capture->endFrame();
+        if (capture->finished())
         {
-            assert(drawable.texture);
-            batch.draw(*drawable.texture, transform.matrix);
-        });
+            qInfo() << "Draw capture done," << capture->framesWritten() << "frames," << capture->bytesWritten() << "bytes";
+            capture.reset();
+            captureDevice.reset();
+        }
+    }
 }
 
 void Scene::timerEvent(QTimerEvent* event)
 {
     if (event->timerId() == timer.timerId())
+    {
+        flush();
+    }
+}
+
+void Scene::step()
+{
+    if (replaying)
+    {
+        if (!player)
+        {
+            // Ended on a corrupt frame, the last good one stays on screen
+            return;
+        }
+        try
+        {
+            player->decodeNext();
+        }
+        catch (const StreamFormatException& error)
+        {
+            qWarning() << "Replay stopped:" << error.what();
+            player.reset();
+            streamDevice.reset();
+        }
+    }
+    else
     {
         World::getInstance().update();
+        if (recorder)
+        {
+            recorder->encode(World::getInstance().registry);
+        }
+    }
+}
 
-        flush();
+void Scene::limitTextureDensity() const
+{
+    // The window never gets taller than its screen, textures need no more texels than that shows
+    const QScreen* display = screen();
+    if (display && camera_zoom > 0)
+    {
+        const float pixels = static_cast<float>(display->size().height() * display->devicePixelRatio());
+        TextureManager::getInstance().setDisplayDensity(pixels * camera_zoom / 2);
     }
 }
 
 void Scene::startGameLoop()
 {
+    limitTextureDensity();
     auto& registry = World::getInstance().registry;
     const auto& background = registry.create();
-    registry.emplace<Transform>(background, Transform{.matrix = Matrix::fromTranslation({0, 0, -1})});
+    registry.emplace<Transform>(background, Transform::fromTranslation({0, 0, -1}));
     registry.emplace<Drawable>(background);
     registry.emplace<Animator>(background);
     struct background_anim
@@ -50,20 +114,52 @@ void Scene::startGameLoop()
 
 
     World::getInstance().init();
+    simulation.start(std::chrono::milliseconds(16));
     timer.start(16, this);
 }
 
+void Scene::startRecording(std::unique_ptr<QIODevice> device)
+{
+    streamDevice = std::move(device);
+    recorder = std::make_unique<WorldStateEncoder>(streamDevice.get());
+    // a file has no back channel to acknowledge frames
+    recorder->setAutoAcknowledge(true);
+    recorder->setKeyframeInterval(600);
+}
+
+void Scene::startReplay(std::unique_ptr<QIODevice> device)
+{
+    streamDevice = std::move(device);
+    limitTextureDensity();
+    player = std::make_unique<WorldStateDecoder>(streamDevice.get(), World::getInstance().registry);
+    replaying = true;
+    simulation.start(std::chrono::milliseconds(16));
+    timer.start(16, this);
+}
+
+void Scene::startCapture(std::unique_ptr<QIODevice> device, const uint32_t first, const uint32_t frameCount)
+{
+    captureDevice = std::move(device);
+    capture = std::make_unique<DrawCapture>(captureDevice.get());
+    capture->setRange(first, frameCount);
+}
+
 void Scene::keyReleaseEvent(QKeyEvent* event)
 {
-    EventManager::getInstance().dispatcher.trigger(ReleaseKey{static_cast<Key>(event->key())});
+    simulation.postKey(static_cast<Key>(event->key()), false);
 }
 
-Scene::Scene()
+Scene::Scene() : simulation([this] { step(); })
 {
     camera_zoom = 0.018;
 }
 
+Scene::~Scene()
+{
+    simulation.stop();
+}
+
 void Scene::keyPressEvent(QKeyEvent* event)
 {
-    EventManager::getInstance().dispatcher.trigger(PressKey{static_cast<Key>(event->key())});
+    simulation.postKey(static_cast<Key>(event->key()), true);
 }
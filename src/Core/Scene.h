@@ -4,25 +4,66 @@
 
 #ifndef SCENE_H
 #define SCENE_H
+#include <memory>
 #include <QBasicTimer>
+#include <QIODevice>
 #include <qevent.h>
 
 #include "QRenderer2D.h"
+#include "Simulation.h"
 #include "../Events/KeyEvents.h"
 #include "../Managers/EventManager.h"
+#include "../Render/DrawCapture.h"
+#include "../Render/HudLayer.h"
+#include "../Replay/WorldStateDecoder.h"
+#include "../Replay/WorldStateEncoder.h"
 
 
 class Scene final : public QRenderer2D {
 public:
     Scene();
+    ~Scene() override;
     void render(SpiritBatch &batch) override;
     void timerEvent(QTimerEvent* event) override;
     void startGameLoop();
+    // Write every simulated tick to the device, must be called before startGameLoop
+    void startRecording(std::unique_ptr<QIODevice> device);
+    // Render a recorded or streamed match instead of simulating one, no system runs in this mode
+    void startReplay(std::unique_ptr<QIODevice> device);
+    // Write the draw calls of frameCount rendered frames, starting at frame first, to the device
+    void startCapture(std::unique_ptr<QIODevice> device, uint32_t first, uint32_t frameCount);
 
     void keyReleaseEvent(QKeyEvent *event) override;
 
+    // Paces painting only, ticks run on the simulation thread
     QBasicTimer timer;
     void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    // One tick, on the simulation thread
+    void step();
+    // Caps the resolution textures are loaded at to what the screen can show at the current zoom
+    void limitTextureDensity() const;
+
+    // Per frame conversion of the snapshot transforms, kept around to reuse the allocation
+    std::vector<float> drawMatrices;
+
+    // Only touched by the simulation thread once it runs
+    std::unique_ptr<QIODevice> streamDevice;
+    std::unique_ptr<WorldStateEncoder> recorder;
+    std::unique_ptr<WorldStateDecoder> player;
+    // Set before the simulation starts, the player is dropped if the stream turns out to be corrupt
+    bool replaying = false;
+
+    // Cached between frames, repainted only where the bound status values changed
+    HudLayer hud;
+
+    // Draw capture, only touched by the GUI thread
+    std::unique_ptr<QIODevice> captureDevice;
+    std::unique_ptr<DrawCapture> capture;
+
+    // Last member, so its thread is joined before anything it uses goes away
+    Simulation simulation;
 };
 
 
@@ -0,0 +1,168 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "Simulation.h"
+
+#include <cassert>
+
+#include "World.h"
+#include "../Components/Chunk.h"
+#include "../Components/Drawable.h"
+#include "../Components/Status.h"
+#include "../Components/Types.h"
+#include "../Managers/EventManager.h"
+#include "../Managers/TextureManager.h"
+#include "../Systems/VisibilitySystem.h"
+
+Simulation::Simulation(Tick tick) : tick(std::move(tick)), renderQueue(World::getInstance().registry)
+{
+}
+
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start(const std::chrono::milliseconds interval)
+{
+    assert(!isRunning());
+    this->interval = interval;
+    thread = std::jthread([this](const std::stop_token& stopToken) { run(stopToken); });
+}
+
+void Simulation::stop()
+{
+    if (thread.joinable())
+    {
+        thread.request_stop();
+        thread.join();
+    }
+}
+
+void Simulation::postKey(const Key key, const bool pressed)
+{
+    std::lock_guard lock(inputMutex);
+    pendingInput.push_back({key, pressed});
+}
+
+void Simulation::setView(const float zoom, const float aspect, const float pixelHeight)
+{
+    viewZoom.store(zoom, std::memory_order_relaxed);
+    viewAspect.store(aspect, std::memory_order_relaxed);
+    viewPixels.store(pixelHeight, std::memory_order_relaxed);
+}
+
+const RenderSnapshot* Simulation::acquireSnapshot()
+{
+    hasSnapshot |= snapshots.update();
+    if (!hasSnapshot)
+    {
+        return nullptr;
+    }
+    const RenderSnapshot& snapshot = snapshots.readBuffer();
+    renderedTick.store(snapshot.tick, std::memory_order_release);
+    return &snapshot;
+}
+
+void Simulation::run(const std::stop_token& stopToken)
+{
+    auto next = std::chrono::steady_clock::now();
+    while (!stopToken.stop_requested())
+    {
+        dispatchInput();
+        tick();
+        publishSnapshot();
+        // Only textures the renderer can no longer be holding from an older snapshot are freed
+        TextureManager::getInstance().collect(tickCount, renderedTick.load(std::memory_order_acquire));
+
+        next += interval;
+        const auto now = std::chrono::steady_clock::now();
+        if (next < now)
+        {
+            // A long tick pushes the schedule back instead of bursting through the missed ticks
+            next = now;
+        }
+        else
+        {
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+void Simulation::dispatchInput()
+{
+    {
+        std::lock_guard lock(inputMutex);
+        drainedInput.swap(pendingInput);
+    }
+    auto& dispatcher = EventManager::getInstance().dispatcher;
+    for (const auto& input : drainedInput)
+    {
+        if (input.pressed)
+        {
+            dispatcher.trigger(PressKey{input.key});
+        }
+        else
+        {
+            dispatcher.trigger(ReleaseKey{input.key});
+        }
+    }
+    drainedInput.clear();
+}
+
+void Simulation::publishSnapshot()
+{
+    auto& registry = World::getInstance().registry;
+    renderQueue.update();
+    visibleEntities.clear();
+    VisibilitySystem::getInstance().collectVisible(cameraArea(), visibleEntities);
+    renderQueue.order(visibleEntities);
+
+    RenderSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.clear();
+    snapshot.tick = ++tickCount;
+    // The camera shows 2 / zoom world units over the viewport height
+    const float pixelsPerUnit =
+        viewPixels.load(std::memory_order_relaxed) * viewZoom.load(std::memory_order_relaxed) / 2;
+    for (const auto entity : visibleEntities)
+    {
+        const auto& drawable = registry.get<Drawable>(entity);
+        assert(drawable.texture);
+        snapshot.textures.push_back(drawable.texture.level(pixelsPerUnit));
+        snapshot.transforms.push_back(placement(drawable, registry.get<Transform>(entity)));
+        snapshot.colors.push_back(drawable.color);
+        if (const auto chunk = registry.try_get<BakedChunk>(entity))
+        {
+            snapshot.retained.push_back(chunk->texture);
+        }
+    }
+    snapshot.hud = collectHud(registry);
+    snapshots.publish();
+}
+
+HudState Simulation::collectHud(const entt::registry& registry)
+{
+    HudState hud;
+    const auto players = registry.view<const TypePlayer, const StatusPlayer>();
+    if (players.begin() == players.end())
+    {
+        return hud;
+    }
+    const auto player = *players.begin();
+    hud.visible = true;
+    hud.health = registry.get<const StatusPlayer>(player).health;
+    if (const auto buff = registry.try_get<const StatusBuff>(player))
+    {
+        hud.buffs = buff->active;
+    }
+    return hud;
+}
+
+b2AABB Simulation::cameraArea() const
+{
+    // zoom maps world units to clip space vertically, the horizontal extent follows the widget aspect
+    const float halfHeight = 1.0f / viewZoom.load(std::memory_order_relaxed);
+    const float halfWidth = halfHeight * viewAspect.load(std::memory_order_relaxed);
+    return b2AABB{.lowerBound = {-halfWidth, -halfHeight}, .upperBound = {halfWidth, halfHeight}};
+}
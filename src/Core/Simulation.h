@@ -0,0 +1,93 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Events/KeyEvents.h"
+#include "../Render/RenderQueue.h"
+#include "../Render/RenderSnapshot.h"
+#include "../Utils/TripleBuffer.h"
+#include "box2d/math_functions.h"
+
+/*
+    Runs the game ticks on a thread of their own, away from the Qt GUI thread.
+    After every tick the visible sprites are culled, ordered and published as a RenderSnapshot through a triple
+    buffer, so painting never waits for a tick and a long tick never blocks painting or input.
+    Once started, the registry (and every system) belongs to this thread; the GUI only posts input and reads
+    snapshots.
+*/
+class Simulation
+{
+public:
+    using Tick = std::function<void()>;
+
+    explicit Simulation(Tick tick);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void start(std::chrono::milliseconds interval);
+    void stop();
+
+    bool isRunning() const
+    {
+        return thread.joinable();
+    }
+
+    // Queues a key event for the next tick, safe from any thread
+    void postKey(Key key, bool pressed);
+
+    // Camera seen by the next snapshots, safe from any thread. pixelHeight is the viewport height in device pixels,
+    // sprites are drawn from the texture level matching it
+    void setView(float zoom, float aspect, float pixelHeight);
+
+    // Newest published snapshot, nullptr before the first tick. GUI thread only, valid until the next call
+    const RenderSnapshot* acquireSnapshot();
+
+private:
+    struct KeyInput
+    {
+        Key key;
+        bool pressed;
+    };
+
+    Tick tick;
+    std::chrono::milliseconds interval{16};
+    std::jthread thread;
+
+    std::mutex inputMutex;
+    std::vector<KeyInput> pendingInput;
+    // Swapped with pendingInput under the lock, dispatched outside of it
+    std::vector<KeyInput> drainedInput;
+
+    std::atomic<float> viewZoom{1};
+    std::atomic<float> viewAspect{1};
+    std::atomic<float> viewPixels{0};
+
+    RenderQueue renderQueue;
+    std::vector<entt::entity> visibleEntities;
+    TripleBuffer<RenderSnapshot> snapshots;
+    uint32_t tickCount = 0;
+    // Tick of the snapshot the GUI thread acquired last, it never goes back to an older one
+    std::atomic<uint32_t> renderedTick{0};
+    bool hasSnapshot = false;
+
+    void run(const std::stop_token& stopToken);
+    void dispatchInput();
+    void publishSnapshot();
+    static HudState collectHud(const entt::registry& registry);
+    // World space rectangle the camera shows, the camera looks at the origin
+    b2AABB cameraArea() const;
+};
+
+
+#endif //SIMULATION_H
@@ -0,0 +1,50 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETID_H
+#define ASSETID_H
+#include <cstddef>
+#include <string_view>
+
+#include "entt/core/hashed_string.hpp"
+
+/*
+    Name of a texture directory or clip hashed at compile time, like entt::hashed_string (same FNV-1a, a trailing
+    '/' is not part of the name). TextureManager resolves an id to a dense index of its asset table the first time
+    it sees it, later requests index that table instead of building and hashing path strings.
+
+        constexpr AssetId projectileTextures("assets/projectile");
+        using namespace AssetLiterals;
+        manager.getTextures("assets/platform/static"_asset, index, {});
+
+    The name is viewed, not copied: build ids from literals or strings that outlive the request.
+*/
+struct AssetId
+{
+    std::string_view name;
+    entt::id_type value = 0;
+
+    constexpr AssetId() = default;
+
+    constexpr explicit AssetId(const std::string_view directory)
+        : name(directory.ends_with('/') ? directory.substr(0, directory.size() - 1) : directory),
+          value(entt::hashed_string::value(name.data(), name.size()))
+    {
+    }
+
+    constexpr bool operator==(const AssetId& other) const
+    {
+        return value == other.value;
+    }
+};
+
+namespace AssetLiterals
+{
+    constexpr AssetId operator""_asset(const char* name, const std::size_t length)
+    {
+        return AssetId(std::string_view(name, length));
+    }
+}
+
+#endif //ASSETID_H
@@ -0,0 +1,92 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "AssetManifest.h"
+
+#include <cstring>
+#include <QDebug>
+#include <QFile>
+
+using namespace AssetManifestFormat;
+
+bool AssetManifest::open(const std::string& path)
+{
+    close();
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "AssetManifest: Cannot open" << file.fileName();
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    const auto size = static_cast<uint64_t>(data.size());
+    Header header{};
+    if (size >= sizeof(Header))
+    {
+        std::memcpy(&header, data.constData(), sizeof(Header));
+    }
+    const uint64_t directoriesOffset = sizeof(Header);
+    const uint64_t clipsOffset = directoriesOffset + uint64_t{header.directoryCount} * sizeof(DirectoryEntry);
+    const uint64_t filesOffset = clipsOffset + uint64_t{header.clipCount} * sizeof(ClipEntry);
+    const uint64_t stringsOffset = filesOffset + uint64_t{header.fileCount} * sizeof(FileEntry);
+    if (size < sizeof(Header) || header.magic != magic || header.version != version ||
+        stringsOffset + header.stringsSize > size)
+    {
+        qWarning() << "AssetManifest: Not a valid manifest" << file.fileName();
+        return false;
+    }
+
+    const char* bytes = data.constData();
+    const auto string = [&](const uint32_t offset, const uint32_t length)
+    {
+        return offset <= header.stringsSize && length <= header.stringsSize - offset
+                   ? std::string(bytes + stringsOffset + offset, length)
+                   : std::string();
+    };
+    std::vector<std::string> paths(header.fileCount);
+    for (uint32_t f = 0; f < header.fileCount; f++)
+    {
+        FileEntry entry;
+        std::memcpy(&entry, bytes + filesOffset + f * sizeof(FileEntry), sizeof(entry));
+        paths[f] = string(entry.pathOffset, entry.pathLength);
+    }
+    const auto addListing = [&](const std::string& name, const uint32_t first, const uint32_t count)
+    {
+        if (!name.empty() && uint64_t{first} + count <= header.fileCount)
+        {
+            listings[name].assign(paths.begin() + first, paths.begin() + first + count);
+        }
+    };
+    for (uint32_t d = 0; d < header.directoryCount; d++)
+    {
+        DirectoryEntry entry;
+        std::memcpy(&entry, bytes + directoriesOffset + d * sizeof(DirectoryEntry), sizeof(entry));
+        addListing(string(entry.nameOffset, entry.nameLength), entry.firstFile, entry.fileCount);
+    }
+    for (uint32_t c = 0; c < header.clipCount; c++)
+    {
+        ClipEntry entry;
+        std::memcpy(&entry, bytes + clipsOffset + c * sizeof(ClipEntry), sizeof(entry));
+        addListing(string(entry.nameOffset, entry.nameLength), entry.firstFile, entry.fileCount);
+    }
+    opened = true;
+    return true;
+}
+
+void AssetManifest::close()
+{
+    listings.clear();
+    opened = false;
+}
+
+const std::vector<std::string>* AssetManifest::listing(const std::string& name) const
+{
+    auto it = listings.find(name);
+    if (it == listings.end() && name.size() > 1 && name.back() == '/')
+    {
+        // A clip asked for like a directory
+        it = listings.find(name.substr(0, name.size() - 1));
+    }
+    return it == listings.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,40 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETMANIFEST_H
+#define ASSETMANIFEST_H
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetManifestFormat.h"
+
+/*
+    Read side of the manifest written by `lucknight_cook --manifest` (see AssetManifestFormat.h): every image path,
+    listed by directory and by clip. Loaded into a hash map once, so listing a directory or a clip never touches
+    the filesystem.
+*/
+class AssetManifest
+{
+public:
+    // Reads the manifest, false (with a warning) if it is missing or malformed
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const
+    {
+        return opened;
+    }
+
+    // Files of a directory or frames of a clip in natural order, nullptr if the manifest holds neither
+    const std::vector<std::string>* listing(const std::string& name) const;
+
+private:
+    bool opened = false;
+    // Directories (with their trailing '/') and clips share one table, their names cannot collide
+    std::unordered_map<std::string, std::vector<std::string>> listings;
+};
+
+
+#endif //ASSETMANIFEST_H
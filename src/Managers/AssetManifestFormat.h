@@ -0,0 +1,71 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETMANIFESTFORMAT_H
+#define ASSETMANIFESTFORMAT_H
+#include <bit>
+#include <cstdint>
+
+/*
+    On-disk layout of the asset manifest written by `lucknight_cook --manifest` and read by AssetManifest.
+    All integers are little endian.
+
+        Header                      32 bytes
+        DirectoryEntry[directoryCount]
+        ClipEntry[clipCount]
+        FileEntry[fileCount]
+        string table                utf-8 paths, not terminated
+
+    Files are stored directory by directory in natural order (FileUtils::listImages), so the files of a directory
+    and the frames of each clip are consecutive runs of the file table. A clip is named like the files it groups,
+    without the frame number: assets/特效/alchemist_0_skill_2_effect_0 holds alchemist_0_skill_2_effect_0_*.png.
+    Directory names carry a trailing '/', every path is spelled the way the game asks for it.
+*/
+namespace AssetManifestFormat
+{
+    static_assert(std::endian::native == std::endian::little, "the manifest is read in place");
+
+    constexpr uint32_t magic = 0x4D4D4B4C; // "LKMM"
+    constexpr uint32_t version = 2;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t directoryCount;
+        uint32_t clipCount;
+        uint32_t fileCount;
+        uint32_t stringsSize;
+        uint64_t reserved;
+    };
+
+    struct DirectoryEntry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstFile;
+        uint32_t fileCount;
+    };
+
+    struct ClipEntry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstFile;
+        uint32_t fileCount;
+    };
+
+    struct FileEntry
+    {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    static_assert(sizeof(Header) == 32);
+    static_assert(sizeof(DirectoryEntry) == 16);
+    static_assert(sizeof(ClipEntry) == 16);
+    static_assert(sizeof(FileEntry) == 8);
+}
+
+#endif //ASSETMANIFESTFORMAT_H
@@ -0,0 +1,175 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "AssetPack.h"
+
+#include <cassert>
+#include <QDebug>
+
+#ifdef LUCKNIGHT_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+using namespace AssetPackFormat;
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+bool AssetPack::open(const std::string& path)
+{
+    close();
+    file.setFileName(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "AssetPack: Cannot open" << file.fileName();
+        return false;
+    }
+    const auto size = static_cast<uint64_t>(file.size());
+    const uchar* mapped = file.map(0, file.size());
+    if (!mapped || size < sizeof(Header))
+    {
+        qWarning() << "AssetPack: Cannot map" << file.fileName();
+        file.close();
+        return false;
+    }
+
+    const auto header = reinterpret_cast<const Header*>(mapped);
+    const auto fits = [size](const uint64_t offset, const uint64_t bytes)
+    {
+        return offset <= size && bytes <= size - offset;
+    };
+    if (header->magic != magic || header->version != version ||
+        !fits(header->directoriesOffset, uint64_t{header->directoryCount} * sizeof(DirectoryEntry)) ||
+        !fits(header->framesOffset, uint64_t{header->frameCount} * sizeof(FrameEntry)) ||
+        !fits(header->recordsOffset, uint64_t{header->recordCount} * sizeof(RecordEntry)) ||
+        !fits(header->stringsOffset, header->stringsSize))
+    {
+        qWarning() << "AssetPack: Not a valid pack" << file.fileName();
+        file.close();
+        return false;
+    }
+
+    const auto directoryTable = reinterpret_cast<const DirectoryEntry*>(mapped + header->directoriesOffset);
+    const auto frameTable = reinterpret_cast<const FrameEntry*>(mapped + header->framesOffset);
+    const auto strings = reinterpret_cast<const char*>(mapped + header->stringsOffset);
+    records = reinterpret_cast<const RecordEntry*>(mapped + header->recordsOffset);
+    recordCount = header->recordCount;
+    const auto string = [&](const uint32_t offset, const uint32_t length)
+    {
+        return offset <= header->stringsSize && length <= header->stringsSize - offset
+                   ? std::string(strings + offset, length)
+                   : std::string();
+    };
+
+    for (uint32_t r = 0; r < recordCount; r++)
+    {
+        const RecordEntry& record = records[r];
+        if (!fits(record.offset, record.storedSize) ||
+            (record.compression == None &&
+                record.storedSize != uint64_t{record.width} * record.height * bytesPerPixel))
+        {
+            qWarning() << "AssetPack: Corrupt record" << r << "in" << file.fileName();
+            records = nullptr;
+            file.close();
+            return false;
+        }
+    }
+    for (uint32_t d = 0; d < header->directoryCount; d++)
+    {
+        const DirectoryEntry& entry = directoryTable[d];
+        if (uint64_t{entry.firstFrame} + entry.frameCount > header->frameCount)
+        {
+            continue;
+        }
+        auto& listing = directories[string(entry.nameOffset, entry.nameLength)];
+        for (uint32_t f = entry.firstFrame; f < entry.firstFrame + entry.frameCount; f++)
+        {
+            const FrameEntry& frameEntry = frameTable[f];
+            if (frameEntry.record >= recordCount ||
+                uint64_t{frameEntry.x} + frameEntry.width > records[frameEntry.record].width ||
+                uint64_t{frameEntry.y} + frameEntry.height > records[frameEntry.record].height)
+            {
+                continue;
+            }
+            std::string path = string(frameEntry.pathOffset, frameEntry.pathLength);
+            const QRect kept(static_cast<int>(frameEntry.trimX), static_cast<int>(frameEntry.trimY),
+                             static_cast<int>(frameEntry.width), static_cast<int>(frameEntry.height));
+            const QSize canvas(static_cast<int>(frameEntry.canvasWidth), static_cast<int>(frameEntry.canvasHeight));
+            frames[path] = Frame{
+                .record = frameEntry.record,
+                .rect = QRect(static_cast<int>(frameEntry.x), static_cast<int>(frameEntry.y),
+                              static_cast<int>(frameEntry.width), static_cast<int>(frameEntry.height)),
+                .trim = {
+                    .canvas = canvas,
+                    .rect = kept.size() == canvas || !QRect(QPoint(), canvas).contains(kept) ? QRect() : kept
+                }
+            };
+            listing.push_back(std::move(path));
+        }
+    }
+    data = mapped;
+    return true;
+}
+
+void AssetPack::close()
+{
+    directories.clear();
+    frames.clear();
+    records = nullptr;
+    recordCount = 0;
+    data = nullptr;
+    if (file.isOpen())
+    {
+        file.close();
+    }
+}
+
+const std::vector<std::string>* AssetPack::directory(const std::string& name) const
+{
+    const auto it = directories.find(name);
+    return it == directories.end() ? nullptr : &it->second;
+}
+
+const AssetPack::Frame* AssetPack::frame(const std::string& path) const
+{
+    const auto it = frames.find(path);
+    return it == frames.end() ? nullptr : &it->second;
+}
+
+QImage AssetPack::record(const uint32_t index)
+{
+    assert(isOpen() && index < recordCount);
+    const RecordEntry& entry = records[index];
+    const int width = static_cast<int>(entry.width);
+    const int height = static_cast<int>(entry.height);
+    if (entry.compression == None)
+    {
+        // Read only view of the mapping, Qt copies on the first write
+        return QImage(data + entry.offset, width, height, width * bytesPerPixel,
+                      QImage::Format_ARGB32_Premultiplied);
+    }
+
+#ifdef LUCKNIGHT_HAVE_LZ4
+    if (entry.compression == LZ4)
+    {
+        QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+        const int rawSize = width * height * static_cast<int>(bytesPerPixel);
+        // stride is width * 4 for ARGB32, already 4 byte aligned, so the decoded rows land in place
+        const int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(data + entry.offset),
+                                                reinterpret_cast<char*>(image.bits()),
+                                                static_cast<int>(entry.storedSize), rawSize);
+        if (decoded == rawSize)
+        {
+            return image;
+        }
+        qWarning() << "AssetPack: Corrupt LZ4 record" << index;
+        return {};
+    }
+#endif
+    qWarning() << "AssetPack: Record" << index << "uses compression" << entry.compression
+        << "which this build cannot read";
+    return {};
+}
@@ -0,0 +1,72 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QFile>
+#include <QImage>
+
+#include "AssetPackFormat.h"
+#include "../Render/SpriteTrim.h"
+
+/*
+    Read side of the pack written by lucknight_cook (see AssetPackFormat.h).
+    The file is memory mapped, uncompressed records are handed out as QImages over the mapping without any
+    copy or decode, compressed ones are expanded on every call. Nothing is kept here, so a texture or page the
+    TextureManager evicts frees its pixels.
+*/
+class AssetPack
+{
+public:
+    struct Frame
+    {
+        uint32_t record;
+        QRect rect;
+        SpriteTrim::Trim trim;
+    };
+
+    AssetPack() = default;
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps the pack, false (with a warning) if it is missing or malformed
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const
+    {
+        return data != nullptr;
+    }
+
+    // Frame paths of a directory in natural order, nullptr if the pack does not hold it
+    const std::vector<std::string>* directory(const std::string& name) const;
+
+    // Where a frame lives, nullptr if the pack does not hold it
+    const Frame* frame(const std::string& path) const;
+
+    // Pixels of a record, null image if a compressed record cannot be expanded. Compressed records are expanded
+    // again on every call, keep the image
+    QImage record(uint32_t index);
+
+    bool isPage(const uint32_t index) const
+    {
+        return records[index].flags & AssetPackFormat::RecordIsPage;
+    }
+
+private:
+    QFile file;
+    const uchar* data = nullptr;
+    const AssetPackFormat::RecordEntry* records = nullptr;
+    uint32_t recordCount = 0;
+
+    std::unordered_map<std::string, std::vector<std::string>> directories;
+    std::unordered_map<std::string, Frame> frames;
+};
+
+
+#endif //ASSETPACK_H
@@ -0,0 +1,112 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETPACKFORMAT_H
+#define ASSETPACKFORMAT_H
+#include <bit>
+#include <cstdint>
+
+/*
+    On-disk layout of the asset pack written by lucknight_cook and mapped by AssetPack.
+    All integers are little endian, the tables are read in place from the mapped file.
+
+        Header                      64 bytes
+        pixel records               each at a 64 byte aligned offset
+        DirectoryEntry[directoryCount]
+        FrameEntry[frameCount]
+        RecordEntry[recordCount]
+        string table                utf-8 paths, not terminated
+
+    A record is a premultiplied ARGB32 image (QImage::Format_ARGB32_Premultiplied, stride = width * 4), either an
+    atlas page holding the frames of one directory or a frame too large for a page. Records may be LZ4 compressed.
+    Directory names carry a trailing '/', names and frame paths are spelled the way the game asks for them
+    (relative to the directory the cooker was run from).
+*/
+namespace AssetPackFormat
+{
+    static_assert(std::endian::native == std::endian::little, "the pack is mapped in place");
+
+    constexpr uint32_t magic = 0x4B504B4C; // "LKPK"
+    // 2: frames are trimmed to their opaque pixels
+    constexpr uint32_t version = 2;
+    constexpr uint64_t alignment = 64;
+    constexpr uint32_t bytesPerPixel = 4;
+
+    enum Compression : uint32_t
+    {
+        None = 0,
+        LZ4 = 1,
+    };
+
+    enum RecordFlags : uint32_t
+    {
+        // The record is an atlas page, its frames are sub rectangles of it
+        RecordIsPage = 1 << 0,
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t directoryCount;
+        uint32_t frameCount;
+        uint32_t recordCount;
+        uint32_t reserved;
+        uint64_t directoriesOffset;
+        uint64_t framesOffset;
+        uint64_t recordsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    struct DirectoryEntry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        // Frames of a directory are consecutive, in natural file name order
+        uint32_t firstFrame;
+        uint32_t frameCount;
+    };
+
+    struct FrameEntry
+    {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        uint32_t record;
+        // Pixels of the frame inside its record, its fully transparent border cut off
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+        // Size of the source image and where the kept pixels sat in it (SpriteTrim::Trim), the frame covers
+        // the whole image when they are the same size
+        uint32_t canvasWidth;
+        uint32_t canvasHeight;
+        uint32_t trimX;
+        uint32_t trimY;
+        uint32_t reserved;
+    };
+
+    struct RecordEntry
+    {
+        uint64_t offset;
+        uint64_t storedSize;
+        uint32_t width;
+        uint32_t height;
+        uint32_t compression;
+        uint32_t flags;
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(sizeof(DirectoryEntry) == 16);
+    static_assert(sizeof(FrameEntry) == 48);
+    static_assert(sizeof(RecordEntry) == 32);
+
+    constexpr uint64_t align(const uint64_t offset)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+#endif //ASSETPACKFORMAT_H
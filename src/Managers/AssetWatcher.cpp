@@ -0,0 +1,99 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "AssetWatcher.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <QDebug>
+#include <QFileInfo>
+
+#include "TextureManager.h"
+
+AssetWatcher::AssetWatcher()
+{
+    QObject::connect(&watcher, &QFileSystemWatcher::fileChanged, [this](const QString& path) { onFileChanged(path); });
+    QObject::connect(&watcher, &QFileSystemWatcher::directoryChanged,
+                     [this](const QString& directory) { onDirectoryChanged(directory); });
+    QObject::connect(&poll, &QTimer::timeout, [this] { watchLoaded(); });
+    settle.setSingleShot(true);
+    QObject::connect(&settle, &QTimer::timeout, [this] { reloadChanged(); });
+    poll.start(1000);
+    watchLoaded();
+}
+
+void AssetWatcher::watchLoaded()
+{
+    QStringList files;
+    QSet<QString> directories;
+    for (const auto& path : TextureManager::getInstance().takeLoadedPaths())
+    {
+        const QString file = QString::fromStdString(path);
+        const QFileInfo info(file);
+        if (modified.contains(file) || !info.exists())
+        {
+            // Already watched, or a texture of the pack without a file behind it
+            continue;
+        }
+        modified[file] = info.lastModified();
+        files.append(file);
+        directories.insert(info.path());
+    }
+    if (!files.isEmpty())
+    {
+        watcher.addPaths(files);
+    }
+    const QStringList watched = watcher.directories();
+    directories.subtract(QSet<QString>(watched.begin(), watched.end()));
+    if (!directories.isEmpty())
+    {
+        watcher.addPaths(directories.values());
+    }
+}
+
+void AssetWatcher::onFileChanged(const QString& path)
+{
+    if (QFileInfo::exists(path) && !watcher.files().contains(path))
+    {
+        // Replaced by a rename, the watch went with the old file
+        watcher.addPath(path);
+    }
+    changed.insert(path);
+    settle.start(100);
+}
+
+void AssetWatcher::onDirectoryChanged(const QString& directory)
+{
+    for (auto it = modified.cbegin(); it != modified.cend(); ++it)
+    {
+        const QFileInfo info(it.key());
+        if (info.path() == directory && info.exists() && info.lastModified() != it.value())
+        {
+            onFileChanged(it.key());
+        }
+    }
+}
+
+void AssetWatcher::reloadChanged()
+{
+    std::vector<std::string> files;
+    for (const QString& file : std::as_const(changed))
+    {
+        const QFileInfo info(file);
+        if (!info.exists())
+        {
+            // Deleted, or between the steps of a save: reloaded when it shows up again
+            continue;
+        }
+        modified[file] = info.lastModified();
+        files.push_back(file.toStdString());
+    }
+    changed.clear();
+    if (!files.empty())
+    {
+        qDebug() << "AssetWatcher: Reloading" << files.size() << "changed textures";
+        TextureManager::getInstance().reload(files);
+    }
+}
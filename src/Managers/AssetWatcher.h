@@ -0,0 +1,47 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+/*
+    Hot reload of the textures edited while the game runs. Watches the file of every resident texture and the
+    directories holding them (QFileSystemWatcher, inotify on Linux): editors that save in place touch the file,
+    editors that save by renaming a temporary file over it only touch the directory and drop the file watch.
+    Changed files are handed to TextureManager::reload() once they have been quiet for a moment, so a save
+    written in several steps reloads once. Lives on the GUI thread, it needs an event loop.
+*/
+class AssetWatcher
+{
+public:
+    AssetWatcher();
+
+private:
+    QFileSystemWatcher watcher;
+    // Picks up textures loaded since the last poll
+    QTimer poll;
+    // Restarted by every change, reloads when it runs out
+    QTimer settle;
+
+    // Modification time of every watched file when it was last loaded
+    QHash<QString, QDateTime> modified;
+    QSet<QString> changed;
+
+    void watchLoaded();
+
+    void onFileChanged(const QString& path);
+
+    void onDirectoryChanged(const QString& directory);
+
+    void reloadChanged();
+};
+
+
+#endif //ASSETWATCHER_H
@@ -0,0 +1,165 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "DecodeCache.h"
+
+#include <bit>
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+    static_assert(std::endian::native == std::endian::little, "entries are mapped in place");
+
+    constexpr uint32_t magic = 0x43444B4C; // "LKDC"
+    constexpr uint32_t version = 1;
+    constexpr uint64_t alignment = 64;
+    constexpr uint32_t bytesPerPixel = 4;
+
+    // Followed by the source path (utf-8, not terminated), the pixels start at pixelsOffset with stride width * 4
+    struct EntryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceSize;
+        // Milliseconds since the epoch
+        int64_t sourceModified;
+        float scale;
+        uint32_t pathLength;
+        uint32_t width;
+        uint32_t height;
+        uint64_t pixelsOffset;
+    };
+
+    static_assert(sizeof(EntryHeader) == 48);
+
+    struct Source
+    {
+        uint64_t size;
+        int64_t modified;
+    };
+
+    // Pixels of a mapped entry when it matches the source, the mapping is released with the last copy of the image
+    QImage mapEntry(const QString& entry, const std::string& path, const Source& source, const Texture::Config& config)
+    {
+        auto* file = new QFile(entry);
+        if (!file->open(QIODevice::ReadOnly) || static_cast<uint64_t>(file->size()) < sizeof(EntryHeader))
+        {
+            delete file;
+            return {};
+        }
+        const auto size = static_cast<uint64_t>(file->size());
+        const uchar* mapped = file->map(0, file->size());
+        if (!mapped)
+        {
+            delete file;
+            return {};
+        }
+        EntryHeader header;
+        std::memcpy(&header, mapped, sizeof(header));
+        const uint64_t pixelBytes = uint64_t{header.width} * header.height * bytesPerPixel;
+        if (header.magic != magic || header.version != version || header.sourceSize != source.size ||
+            header.sourceModified != source.modified || header.scale != static_cast<float>(config.scale) ||
+            header.pathLength != path.size() || sizeof(EntryHeader) + header.pathLength > size ||
+            std::memcmp(mapped + sizeof(EntryHeader), path.data(), path.size()) != 0 ||
+            header.width == 0 || header.height == 0 || header.pixelsOffset > size ||
+            pixelBytes > size - header.pixelsOffset)
+        {
+            delete file;
+            return {};
+        }
+        // The mapping stays valid until the QFile is destroyed, the descriptor is not needed for it
+        file->close();
+        return QImage(mapped + header.pixelsOffset, static_cast<int>(header.width), static_cast<int>(header.height),
+                      static_cast<qsizetype>(header.width) * bytesPerPixel, QImage::Format_ARGB32_Premultiplied,
+                      [](void* info) { delete static_cast<QFile*>(info); }, file);
+    }
+
+    void writeEntry(const QString& entry, const std::string& path, const Source& source,
+                    const Texture::Config& config, const QImage& image)
+    {
+        EntryHeader header{
+            .magic = magic,
+            .version = version,
+            .sourceSize = source.size,
+            .sourceModified = source.modified,
+            .scale = static_cast<float>(config.scale),
+            .pathLength = static_cast<uint32_t>(path.size()),
+            .width = static_cast<uint32_t>(image.width()),
+            .height = static_cast<uint32_t>(image.height()),
+            .pixelsOffset = (sizeof(EntryHeader) + path.size() + alignment - 1) & ~(alignment - 1),
+        };
+        QSaveFile file(entry);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            return;
+        }
+        QByteArray prefix(static_cast<qsizetype>(header.pixelsOffset), '\0');
+        std::memcpy(prefix.data(), &header, sizeof(header));
+        std::memcpy(prefix.data() + sizeof(header), path.data(), path.size());
+        bool written = file.write(prefix) == prefix.size();
+        const qsizetype rowBytes = static_cast<qsizetype>(header.width) * bytesPerPixel;
+        for (int y = 0; written && y < image.height(); y++)
+        {
+            written = file.write(reinterpret_cast<const char*>(image.constScanLine(y)), rowBytes) == rowBytes;
+        }
+        if (!written || !file.commit())
+        {
+            qWarning() << "DecodeCache: Cannot write" << entry;
+        }
+    }
+}
+
+void DecodeCache::setDirectory(const std::string& directory)
+{
+    this->directory = QString::fromStdString(directory);
+    if (!this->directory.isEmpty() && !QDir().mkpath(this->directory))
+    {
+        qWarning() << "DecodeCache: Cannot create" << this->directory << ", decoded textures are not cached";
+        this->directory.clear();
+    }
+}
+
+QString DecodeCache::entryPath(const std::string& path, const Texture::Config& config) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(path.data(), static_cast<qsizetype>(path.size())));
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(&config.scale), sizeof(config.scale)));
+    return directory + '/' + QString::fromLatin1(hash.result().toHex()) + ".px";
+}
+
+QImage DecodeCache::load(const std::string& path, const Texture::Config& config)
+{
+    const QString file = QString::fromStdString(path);
+    const QFileInfo info(file);
+    if (!isEnabled() || !info.isFile())
+    {
+        // Same format as a cached load, content hashes and packing must not depend on the cache being on
+        return QImage(file).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    const Source source{
+        .size = static_cast<uint64_t>(info.size()),
+        .modified = info.lastModified().toMSecsSinceEpoch(),
+    };
+    const QString entry = entryPath(path, config);
+    if (QImage image = mapEntry(entry, path, source, config); !image.isNull())
+    {
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return image;
+    }
+
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    QImage image = QImage(file).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (!image.isNull())
+    {
+        writeEntry(entry, path, source, config, image);
+    }
+    return image;
+}
@@ -0,0 +1,58 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef DECODECACHE_H
+#define DECODECACHE_H
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <QImage>
+#include <QString>
+
+#include "Texture.h"
+
+/*
+    Decoded pixels of image files, kept on disk between runs. Every source file has one entry, named after a hash
+    of its path and Texture::Config, that holds its premultiplied ARGB32 pixels along with the size and modification
+    time the file had when it was decoded. An entry whose file changed since is decoded again and replaced, so
+    editing an asset needs no manual invalidation.
+    Entries are memory mapped, a warm load costs page faults instead of an inflate and a colour conversion.
+    load() is thread safe, entries are written to a temporary file and renamed into place.
+*/
+class DecodeCache
+{
+public:
+    // Entries go into the directory, created if missing. An empty directory disables the cache.
+    // Not to be called while loads are running
+    void setDirectory(const std::string& directory);
+
+    bool isEnabled() const
+    {
+        return !directory.isEmpty();
+    }
+
+    // Premultiplied ARGB32 pixels of an image file, mapped from its entry when fresh, decoded and stored otherwise.
+    // Null image if the file cannot be decoded
+    QImage load(const std::string& path, const Texture::Config& config);
+
+    uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    QString directory;
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+
+    QString entryPath(const std::string& path, const Texture::Config& config) const;
+};
+
+
+#endif //DECODECACHE_H
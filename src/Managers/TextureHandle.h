@@ -0,0 +1,252 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef TEXTUREHANDLE_H
+#define TEXTUREHANDLE_H
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QSizeF>
+
+#include "Texture.h"
+#include "../Render/SpriteCodec.h"
+#include "../Render/SpriteTrim.h"
+#include "../Utils/Hash128.h"
+
+// Entry of the TextureManager slot table a handle counts references on
+struct TextureSlot
+{
+    // Replaced in place by a hot reload, handles read it on every access
+    std::atomic<Texture*> texture{nullptr};
+    // Downsampled levels of texture, largest first, same config. Set before the first handle is handed out and
+    // replaced by a hot reload, on the simulation thread between two snapshots
+    std::vector<Texture*> mips;
+    std::atomic<uint32_t> references{0};
+    // TextureManager tick when the last reference went away, orders evictions
+    std::atomic<uint32_t> lastUsed{0};
+
+    // Config the texture was requested with, before trimming
+    Texture::Config config;
+    // Transparent border cut off the texture, replaced with it by a hot reload
+    SpriteTrim::Trim trim;
+
+    // Pixels of a texture not drawn for a while, texture is then an empty image with the right config until a
+    // draw expands it again. Simulation thread only, like mips
+    SpriteCodec::Packed packed;
+    // TextureManager tick of the last draw through level() or pixels(), simulation thread only
+    uint32_t lastDrawn = 0;
+
+    // Bookkeeping of TextureManager, under its lock
+    std::string path;
+    // Bytes of an image of its own (0 for a view into an atlas page) and of the mips
+    size_t bytes = 0;
+    uint32_t page = UINT32_MAX;
+    // Bumped on eviction, a reference kept without a handle (the asset table) is stale once it differs
+    uint32_t generation = 0;
+    // Given on every load and never reused, unlike texture which packing, expansion and reloads replace
+    uint32_t id = 0;
+    // Too noisy to gain from packing, left expanded
+    bool unpackable = false;
+    // Hash of the pixels as drawn, null when not shared. Other paths served by the texture, evicted with it
+    Hash128 content;
+    std::vector<std::string> aliases;
+
+    // Advanced by TextureManager::collect()
+    inline static std::atomic<uint32_t> clock{0};
+};
+
+/*
+    Shared reference to a texture. Textures handed out by TextureManager stay resident while a handle to them
+    exists, once the last one is gone they may be evicted to stay within the memory budget.
+    Textures owned elsewhere (baked chunks, the HUD surface) are wrapped with unowned() and not counted.
+    A hot reload swaps the texture behind every handle to it, keep the handle rather than the Texture*.
+    Textures not drawn for a while are packed, get() then has the config but not the pixels: draw level() or read
+    pixels(), both on the simulation thread.
+    Copies are thread safe; a handle itself is not, like a shared_ptr.
+*/
+class TextureHandle
+{
+public:
+    TextureHandle() = default;
+
+    static TextureHandle unowned(Texture* texture)
+    {
+        TextureHandle handle;
+        handle.texture = texture;
+        return handle;
+    }
+
+    TextureHandle(const TextureHandle& other) : texture(other.texture), slot(other.slot)
+    {
+        acquire();
+    }
+
+    TextureHandle(TextureHandle&& other) noexcept : texture(other.texture), slot(other.slot)
+    {
+        other.texture = nullptr;
+        other.slot = nullptr;
+    }
+
+    TextureHandle& operator=(const TextureHandle& other)
+    {
+        if (this != &other)
+        {
+            TextureHandle copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    TextureHandle& operator=(TextureHandle&& other) noexcept
+    {
+        TextureHandle moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~TextureHandle()
+    {
+        release();
+    }
+
+    Texture* get() const
+    {
+        return slot ? slot->texture.load(std::memory_order_acquire) : texture;
+    }
+
+    Texture* operator->() const
+    {
+        return get();
+    }
+
+    Texture& operator*() const
+    {
+        return *get();
+    }
+
+    // The texture with its pixels, expanded first when it was packed. Counts as a draw, it stays expanded for a
+    // while. Simulation thread only, like level(), the pointer is valid until the next TextureManager::collect()
+    Texture* pixels() const
+    {
+        if (!slot)
+        {
+            return texture;
+        }
+        slot->lastDrawn = TextureSlot::clock.load(std::memory_order_relaxed);
+        if (!slot->packed.isNull())
+        {
+            expand(slot);
+        }
+        return slot->texture.load(std::memory_order_relaxed);
+    }
+
+    // Smallest level that still has a texel per screen pixel, for a camera showing pixelsPerUnit pixels per
+    // world unit. The texture itself when it has no mips, is drawn larger than its own resolution or the
+    // density is not known yet. Simulation thread only, hot reloads replace the mips there
+    Texture* level(const float pixelsPerUnit) const
+    {
+        Texture* texture = pixels();
+        if (!slot || slot->mips.empty() || pixelsPerUnit <= 0)
+        {
+            return texture;
+        }
+        const float needed = texture->config.scale * pixelsPerUnit;
+        for (auto mip = slot->mips.rbegin(); mip != slot->mips.rend(); ++mip)
+        {
+            if (static_cast<float>((*mip)->image.height()) >= needed)
+            {
+                return *mip;
+            }
+        }
+        return texture;
+    }
+
+    // Centre of the texture relative to the centre of the image it was trimmed from, in world units of an
+    // unscaled sprite. Zero for untrimmed textures. Simulation thread only, like level()
+    QPointF offset() const
+    {
+        return slot ? SpriteTrim::offset(slot->trim, static_cast<float>(slot->config.scale)) : QPointF();
+    }
+
+    // World size of the whole image the texture was cut from, border included, for an unscaled sprite.
+    // The size of the texture itself when untrimmed, empty without an image. Simulation thread only, like level()
+    QSizeF size() const
+    {
+        // Known from the canvas while the pixels are packed
+        if (slot && !slot->trim.canvas.isEmpty())
+        {
+            const auto height = static_cast<double>(slot->config.scale);
+            return {height * slot->trim.canvas.width() / slot->trim.canvas.height(), height};
+        }
+        const Texture* texture = get();
+        if (texture->image.isNull())
+        {
+            return {};
+        }
+        const auto height = static_cast<double>(texture->config.scale);
+        return {height * texture->image.width() / texture->image.height(), height};
+    }
+
+    // Names the texture for as long as it is loaded, whatever replaces get() meanwhile: key caches on this rather
+    // than on the Texture*. 0 for unowned textures
+    uint32_t id() const
+    {
+        return slot ? slot->id : 0;
+    }
+
+    explicit operator bool() const
+    {
+        return slot || texture;
+    }
+
+    bool operator==(const TextureHandle& other) const
+    {
+        return slot == other.slot && texture == other.texture;
+    }
+
+    void swap(TextureHandle& other) noexcept
+    {
+        std::swap(texture, other.texture);
+        std::swap(slot, other.slot);
+    }
+
+private:
+    friend class TextureManager;
+
+    // Unowned textures only
+    Texture* texture = nullptr;
+    // nullptr for unowned textures
+    TextureSlot* slot = nullptr;
+
+    explicit TextureHandle(TextureSlot* slot) : slot(slot)
+    {
+        acquire();
+    }
+
+    // Defined by TextureManager
+    static void expand(TextureSlot* slot);
+
+    void acquire() const
+    {
+        if (slot)
+        {
+            slot->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release()
+    {
+        if (slot && slot->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            slot->lastUsed.store(TextureSlot::clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        texture = nullptr;
+        slot = nullptr;
+    }
+};
+
+#endif //TEXTUREHANDLE_H
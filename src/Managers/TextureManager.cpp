@@ -5,227 +5,1156 @@
 #include "TextureManager.h"
 #include <QImage>
 #include <algorithm>
-#include <QRegularExpression>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#include "../Render/MipChain.h"
+#include "../Render/SpriteCodec.h"
+#include "../Render/SpriteTrim.h"
+#include "../Utils/FileUtils.h"
+
+namespace
+{
+    // Same hash for the same pixels drawn the same way: size, format, scale and trim go into the seed
+    Hash128 contentOf(const QImage& image, const Texture::Config& config, const SpriteTrim::Trim& trim)
+    {
+        const int32_t shape[] = {
+            image.width(), image.height(), static_cast<int32_t>(image.format()),
+            trim.canvas.width(), trim.canvas.height(), trim.rect.x(), trim.rect.y(),
+        };
+        const auto scale = static_cast<float>(config.scale);
+        Hash128 hash = Hash128::of(shape, sizeof(shape), std::bit_cast<uint32_t>(scale));
+        const auto rowBytes = static_cast<size_t>(image.width()) * image.depth() / 8;
+        if (static_cast<size_t>(image.bytesPerLine()) == rowBytes)
+        {
+            return Hash128::of(image.constBits(), rowBytes * image.height(), hash.low ^ hash.high);
+        }
+        // Padded rows, the padding is not part of the content
+        for (int y = 0; y < image.height(); y++)
+        {
+            hash = Hash128::of(image.constScanLine(y), rowBytes, hash.low ^ hash.high);
+        }
+        return hash;
+    }
+
+    // Bytes of the premultiplied ARGB32 image packed
+    size_t expandedBytes(const SpriteCodec::Packed& packed)
+    {
+        return static_cast<size_t>(packed.size.width()) * packed.size.height() * sizeof(uint32_t);
+    }
+
+    size_t bytesOf(const QImage& image, const std::vector<QImage>& mips)
+    {
+        auto bytes = static_cast<size_t>(image.sizeInBytes());
+        for (const QImage& level : mips)
+        {
+            bytes += static_cast<size_t>(level.sizeInBytes());
+        }
+        return bytes;
+    }
+}
+
+struct TextureBatch
+{
+    // Whole directory, the order of the result
+    std::vector<std::string> files;
+    // Files that were not cached when the batch was prepared, decoded into images
+    std::vector<std::string> paths;
+    std::vector<QImage> images;
+    std::vector<std::vector<QImage>> mips;
+    // Border cut off each image
+    std::vector<SpriteTrim::Trim> trims;
+    // Content of each image, left null when the batch is not deduplicated
+    std::vector<Hash128> hashes;
+    bool deduplicate = false;
+    // As requested, before trimming
+    Texture::Config config;
+    DecodeCache* cache;
+    // Images are downsampled to this height when larger, 0 keeps them as they are
+    int maxHeight = 0;
+    // nullptr once decoded
+    enkiTaskSet* task = nullptr;
+};
+
+TextureFuture::TextureFuture() = default;
+
+TextureFuture::TextureFuture(TextureFuture&& other) noexcept = default;
+
+TextureFuture& TextureFuture::operator=(TextureFuture&& other) noexcept
+{
+    if (this != &other)
+    {
+        wait();
+        batch = std::move(other.batch);
+        textures = std::move(other.textures);
+    }
+    return *this;
+}
+
+TextureFuture::~TextureFuture()
+{
+    wait();
+}
+
+bool TextureFuture::ready() const
+{
+    return !batch || TextureManager::getInstance().isDecoded(*batch);
+}
+
+const std::vector<TextureHandle>& TextureFuture::wait()
+{
+    if (batch)
+    {
+        textures = TextureManager::getInstance().finishBatch(*batch);
+        batch.reset();
+    }
+    return textures;
+}
+
+TextureManager::TextureManager()
+{
+    scheduler = enkiNewTaskScheduler();
+    struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig(scheduler);
+    config.numTaskThreadsToCreate = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    config.numExternalTaskThreads = maxLoadingThreads;
+    enkiInitTaskSchedulerWithConfig(scheduler, config);
+    schedulerThread = std::this_thread::get_id();
+}
 
 TextureManager::~TextureManager()
 {
     clearCache();
+    enkiDeleteTaskScheduler(scheduler);
 }
 
-Texture* TextureManager::getTextures(const std::string& directory, int index, const Texture::Config& config)
+bool TextureManager::joinScheduler() const
 {
-    // Make sure the directory path is normalized
-    QString qDir = QString::fromStdString(directory);
-    if (!qDir.endsWith('/'))
+    // enkiTS only takes tasks from the thread that created it and from registered threads
+    if (std::this_thread::get_id() == schedulerThread)
+    {
+        return true;
+    }
+    struct Registration
+    {
+        enkiTaskScheduler* scheduler = nullptr;
+
+        ~Registration()
+        {
+            if (scheduler)
+            {
+                enkiDeRegisterExternalTaskThread(scheduler);
+            }
+        }
+    };
+    thread_local Registration registration;
+    if (!registration.scheduler && enkiRegisterExternalTaskThread(scheduler))
     {
-        qDir += '/';
+        registration.scheduler = scheduler;
+    }
+    return registration.scheduler == scheduler;
+}
+
+void TextureManager::decodeImages(const uint32_t start, const uint32_t end, uint32_t, void* args)
+{
+    auto* batch = static_cast<TextureBatch*>(args);
+    for (uint32_t i = start; i < end; i++)
+    {
+        QImage image = batch->cache->load(batch->paths[i], batch->config);
+        if (!image.isNull())
+        {
+            image = MipChain::fitHeight(image, batch->maxHeight);
+            batch->trims[i] = SpriteTrim::trim(image);
+            if (batch->deduplicate)
+            {
+                batch->hashes[i] = contentOf(image, batch->config, batch->trims[i]);
+            }
+            batch->mips[i] = MipChain::build(image, minMipHeight);
+        }
+        batch->images[i] = std::move(image);
+    }
+}
+
+std::unique_ptr<TextureBatch> TextureManager::prepareBatch(const std::vector<std::string>& files,
+                                                           const Texture::Config& config)
+{
+    auto batch = std::make_unique<TextureBatch>();
+    batch->files = files;
+    batch->config = config;
+    batch->cache = &diskCache;
+    batch->maxHeight = maxHeightFor(config);
+    for (const auto& file : files)
+    {
+        if (textureCache.contains(file))
+        {
+            continue;
+        }
+        uint32_t page;
+        SpriteTrim::Trim trim;
+        Hash128 content;
+        if (Texture* texture = loadPackedTexture(file, config, page, trim, content))
+        {
+            cacheUnique(file, texture, page, config, trim, content);
+            continue;
+        }
+        batch->paths.push_back(file);
+    }
+    batch->images.resize(batch->paths.size());
+    batch->mips.resize(batch->paths.size());
+    batch->trims.resize(batch->paths.size());
+    batch->hashes.resize(batch->paths.size());
+    batch->deduplicate = deduplicating();
+    return batch;
+}
+
+void TextureManager::decodeAsync(TextureBatch& batch)
+{
+    const auto count = static_cast<uint32_t>(batch.paths.size());
+    if (joinScheduler())
+    {
+        batch.task = enkiCreateTaskSet(scheduler, &TextureManager::decodeImages);
+        enkiParamsTaskSet params{};
+        params.setSize = count;
+        params.minRange = 1;
+        params.pArgs = &batch;
+        params.priority = 0;
+        enkiSetParamsTaskSet(batch.task, params);
+        enkiAddTaskSet(scheduler, batch.task);
+    }
+    else
+    {
+        decodeImages(0, count, 0, &batch);
+    }
+}
+
+TextureFuture TextureManager::startBatch(std::unique_ptr<TextureBatch> batch)
+{
+    const auto count = static_cast<uint32_t>(batch->paths.size());
+    if (count > 1)
+    {
+        decodeAsync(*batch);
+    }
+    else
+    {
+        // Not worth a task
+        decodeImages(0, count, 0, batch.get());
+    }
+    TextureFuture future;
+    future.batch = std::move(batch);
+    return future;
+}
+
+bool TextureManager::isDecoded(const TextureBatch& batch) const
+{
+    return !batch.task || enkiIsTaskSetComplete(scheduler, batch.task);
+}
+
+std::vector<TextureHandle> TextureManager::finishBatch(TextureBatch& batch)
+{
+    if (batch.task)
+    {
+        if (joinScheduler())
+        {
+            // Runs decode tasks on this thread until the batch is done
+            enkiWaitForTaskSet(scheduler, batch.task);
+        }
+        else
+        {
+            while (!enkiIsTaskSetComplete(scheduler, batch.task))
+            {
+                std::this_thread::yield();
+            }
+        }
+        enkiDeleteTaskSet(scheduler, batch.task);
+        batch.task = nullptr;
     }
-    std::string normalizedDir = qDir.toStdString();
 
+    std::lock_guard lock(mutex);
+    std::vector<std::string> paths;
+    std::vector<QImage> images;
+    std::vector<std::vector<QImage>> mips;
+    std::vector<SpriteTrim::Trim> trims;
+    std::vector<Hash128> hashes;
+    // Repeated frames of this batch and the first frame with their content, aliased once that one is cached
+    std::vector<std::pair<std::string, size_t>> repeats;
+    std::unordered_map<Hash128, size_t, Hash128::Hasher> firstWith;
+    for (size_t i = 0; i < batch.paths.size(); i++)
+    {
+        // Another load may have cached the file while this batch was decoding
+        if (textureCache.contains(batch.paths[i]))
+        {
+            continue;
+        }
+        if (batch.images[i].isNull())
+        {
+            qWarning() << "TextureManager: Failed to load texture:" << QString::fromStdString(batch.paths[i]);
+            continue;
+        }
+        const Hash128& content = batch.hashes[i];
+        if (!content.isNull())
+        {
+            // Identical pixels are never atlased twice
+            if (TextureSlot* shared = sharedSlot(content))
+            {
+                alias(batch.paths[i], shared, bytesOf(batch.images[i], batch.mips[i]));
+                continue;
+            }
+            const auto [first, inserted] = firstWith.try_emplace(content, paths.size());
+            if (!inserted)
+            {
+                repeats.emplace_back(batch.paths[i], first->second);
+                counters.duplicateBytes += bytesOf(batch.images[i], batch.mips[i]);
+                continue;
+            }
+        }
+        paths.push_back(batch.paths[i]);
+        images.push_back(std::move(batch.images[i]));
+        mips.push_back(std::move(batch.mips[i]));
+        trims.push_back(batch.trims[i]);
+        hashes.push_back(content);
+    }
+
+    if (!images.empty())
+    {
+        const auto regions = atlas.build(images);
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            const Texture::Config config = SpriteTrim::config(batch.config, trims[i]);
+            Texture* texture;
+            if (regions[i].page == TextureAtlas::noPage)
+            {
+                // Too large for a page, keep its own image
+                texture = new Texture{.image = std::move(images[i]), .config = config};
+            }
+            else
+            {
+                texture = new Texture{.image = atlas.view(regions[i]), .config = config};
+            }
+            cacheTexture(paths[i], texture, regions[i].page, std::move(mips[i]), batch.config, trims[i], hashes[i]);
+        }
+    }
+    for (const auto& [path, first] : repeats)
+    {
+        // Bytes were counted above
+        alias(path, textureCache.at(paths[first]), 0);
+    }
+
+    std::vector<TextureHandle> textures;
+    for (const auto& file : batch.files)
+    {
+        const auto it = textureCache.find(file);
+        if (it != textureCache.end())
+        {
+            textures.push_back(TextureHandle(it->second));
+        }
+    }
+    return textures;
+}
+
+const std::vector<std::string>& TextureManager::listDirectory(const std::string& directory)
+{
+    // Make sure the directory path is normalized
+    std::string normalizedDir = directory;
+    if (!normalizedDir.empty() && normalizedDir.back() != '/')
+    {
+        normalizedDir += '/';
+    }
     // Get all files in the directory if not already cached
-    if (directoryCache.find(normalizedDir) == directoryCache.end())
+    auto it = directoryCache.find(normalizedDir);
+    if (it == directoryCache.end())
     {
-        directoryCache[normalizedDir] = getFilesInDirectory(normalizedDir);
+        it = directoryCache.emplace(normalizedDir, getFilesInDirectory(normalizedDir)).first;
     }
+    return it->second;
+}
 
-    const auto& files = directoryCache[normalizedDir];
+TextureSlot* TextureManager::lookup(const std::string& filePath)
+{
+    const auto it = textureCache.find(filePath);
+    if (it == textureCache.end())
+    {
+        counters.misses++;
+        return nullptr;
+    }
+    counters.hits++;
+    return it->second;
+}
+
+TextureHandle TextureManager::getTextures(const std::string& directory, int index, const Texture::Config& config)
+{
+    std::unique_lock lock(mutex);
+    const auto& files = listDirectory(directory);
 
     // Check if index is valid
     if (files.empty())
     {
-        qWarning() << "TextureManager: No files found in directory:"
-            << QString::fromStdString(normalizedDir);
-        return nullptr;
+        qWarning() << "TextureManager: No files found in directory:" << QString::fromStdString(directory);
+        return {};
     }
 
     if (index < 0 || index >= static_cast<int>(files.size()))
     {
         qWarning() << "TextureManager: Invalid index" << index
-            << "for directory:" << QString::fromStdString(normalizedDir)
+            << "for directory:" << QString::fromStdString(directory)
             << "(valid range: 0 to" << files.size() - 1 << ")";
-        return nullptr;
+        return {};
     }
 
     // Get the file path for the requested index
-    std::string filePath = files[index];
+    const std::string& filePath = files[index];
 
     // Check if the texture is already cached
-    if (textureCache.find(filePath) != textureCache.end())
+    if (TextureSlot* slot = lookup(filePath))
     {
-        return textureCache[filePath];
+        return TextureHandle(slot);
     }
 
+    // Load the whole directory, so its frames share atlas pages
+    auto batch = prepareBatch(files, config);
+    const std::string path = filePath;
+    lock.unlock();
+    startBatch(std::move(batch)).wait();
+    lock.lock();
+    const auto it = textureCache.find(path);
+    return it == textureCache.end() ? TextureHandle() : TextureHandle(it->second);
+}
+
+TextureHandle TextureManager::getTexture(const std::string& file, const Texture::Config& config)
+{
+    std::lock_guard lock(mutex);
+    if (TextureSlot* slot = lookup(file))
+    {
+        return TextureHandle(slot);
+    }
     // Load the texture
-    Texture* texture = loadTexture(filePath, config);
-    if (texture)
+    uint32_t page;
+    SpriteTrim::Trim trim;
+    Hash128 content;
+    Texture* texture = loadTexture(file, config, page, trim, content);
+    return texture ? TextureHandle(cacheUnique(file, texture, page, config, trim, content)) : TextureHandle();
+}
+
+uint32_t TextureManager::resolve(const AssetId id)
+{
+    const auto it = assetIndices.find(id.value);
+    if (it != assetIndices.end())
     {
-        textureCache[filePath] = texture;
+        // Two names hashing alike would share an entry
+        assert(assets[it->second].directory == id.name);
+        return it->second;
     }
+    assets.push_back(Asset{.directory = std::string(id.name)});
+    return assetIndices[id.value] = static_cast<uint32_t>(assets.size() - 1);
+}
+
+void TextureManager::bindFrames(Asset& asset)
+{
+    const auto& files = listDirectory(asset.directory);
+    asset.frames.assign(files.size(), {nullptr, 0});
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const auto it = textureCache.find(files[i]);
+        if (it != textureCache.end())
+        {
+            asset.frames[i] = {it->second, it->second->generation};
+        }
+    }
+}
 
+TextureSlot* TextureManager::boundFrame(const Asset& asset, const int index) const
+{
+    if (index < 0 || index >= static_cast<int>(asset.frames.size()))
+    {
+        return nullptr;
+    }
+    const auto& [slot, generation] = asset.frames[index];
+    return slot && slot->texture && slot->generation == generation ? slot : nullptr;
+}
+
+TextureHandle TextureManager::getTextures(const AssetId directory, const int index, const Texture::Config& config)
+{
+    std::unique_lock lock(mutex);
+    const uint32_t asset = resolve(directory);
+    if (TextureSlot* slot = boundFrame(assets[asset], index))
+    {
+        counters.hits++;
+        return TextureHandle(slot);
+    }
+    // First request or evicted since: load by path, then remember where the frames ended up
+    const std::string path = assets[asset].directory;
+    lock.unlock();
+    TextureHandle texture = getTextures(path, index, config);
+    lock.lock();
+    bindFrames(assets[asset]);
     return texture;
 }
 
-Texture* TextureManager::getTexture(const std::string& file, const Texture::Config& config)
+std::vector<TextureHandle> TextureManager::getAllTextures(const AssetId directory, const Texture::Config& config)
 {
-    Texture* texture;
-    if (textureCache.contains(file))
+    std::unique_lock lock(mutex);
+    const uint32_t asset = resolve(directory);
+    std::vector<TextureHandle> textures;
+    const int count = static_cast<int>(assets[asset].frames.size());
+    for (int i = 0; i < count; i++)
     {
-        texture = textureCache[file];
+        TextureSlot* slot = boundFrame(assets[asset], i);
+        if (!slot)
+        {
+            break;
+        }
+        textures.push_back(TextureHandle(slot));
     }
-    else
+    if (count > 0 && static_cast<int>(textures.size()) == count)
     {
-        // Load the texture
-        texture = loadTexture(file, config);
-        if (texture)
+        counters.hits += count;
+        return textures;
+    }
+    const std::string path = assets[asset].directory;
+    lock.unlock();
+    textures = getAllTextures(path, config);
+    lock.lock();
+    bindFrames(assets[asset]);
+    return textures;
+}
+
+std::vector<TextureHandle> TextureManager::getAllTextures(const std::string& directory, const Texture::Config& config)
+{
+    TextureFuture future = loadAllTextures(directory, config);
+    future.wait();
+    return std::move(future.textures);
+}
+
+TextureFuture TextureManager::loadAllTextures(const std::string& directory, const Texture::Config& config)
+{
+    std::unique_ptr<TextureBatch> batch;
+    {
+        std::lock_guard lock(mutex);
+        const auto& files = listDirectory(directory);
+        for (const auto& file : files)
         {
-            textureCache[file] = texture;
+            lookup(file);
         }
+        batch = prepareBatch(files, config);
     }
-    return texture;
+    return startBatch(std::move(batch));
 }
 
-std::vector<Texture*> TextureManager::getAllTextures(const std::string& directory, const Texture::Config& config)
+void TextureManager::clearCache()
 {
-    std::vector<Texture*> textures;
+    std::lock_guard lock(mutex);
+    for (const auto& batch : reloads)
+    {
+        while (!isDecoded(*batch))
+        {
+            std::this_thread::yield();
+        }
+        if (batch->task)
+        {
+            enkiDeleteTaskSet(scheduler, batch->task);
+        }
+    }
+    reloads.clear();
+    // Delete all cached textures
+    for (auto& slot : slots)
+    {
+        delete slot.texture.load(std::memory_order_relaxed);
+        for (const Texture* mip : slot.mips)
+        {
+            delete mip;
+        }
+    }
+    for (const auto& grave : graves)
+    {
+        delete grave.texture;
+    }
+    slots.clear();
+    freeSlots.clear();
+    graves.clear();
+    textureCache.clear();
+    textureSlots.clear();
+    contentSlots.clear();
+    // Atlased textures view the pages, release the pages only after them
+    atlas.clear();
+    pageUsers.clear();
+    packPages.clear();
+    directoryCache.clear();
+    for (auto& asset : assets)
+    {
+        asset.frames.clear();
+    }
+    counters.residentBytes = 0;
+    counters.textures = 0;
+    counters.packed = 0;
+    counters.packedBytes = 0;
+    counters.unpackedBytes = 0;
+}
 
-    // Make sure the directory path is normalized
-    std::string normalizedDir = directory;
-    if (!normalizedDir.empty() && normalizedDir.back() != '/')
+TextureSlot* TextureManager::cacheTexture(const std::string& filePath, Texture* texture, const uint32_t page,
+                                          std::vector<QImage> mips, const Texture::Config& config,
+                                          const SpriteTrim::Trim& trim, const Hash128& content)
+{
+    TextureSlot* slot;
+    if (freeSlots.empty())
     {
-        normalizedDir += '/';
+        slot = &slots.emplace_back();
     }
-    // Get all files in the directory if not already cached
-    if (directoryCache.find(normalizedDir) == directoryCache.end())
+    else
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    slot->references.store(0, std::memory_order_relaxed);
+    slot->lastUsed.store(TextureSlot::clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    slot->path = filePath;
+    slot->config = config;
+    slot->id = ++lastSlotId;
+    // Not packed before it had the time to be drawn
+    slot->lastDrawn = TextureSlot::clock.load(std::memory_order_relaxed);
+    attach(slot, texture, page, std::move(mips), trim);
+    if (!content.isNull())
     {
-        directoryCache[normalizedDir] = getFilesInDirectory(normalizedDir);
+        slot->content = content;
+        contentSlots[content] = slot;
     }
 
-    const auto& files = directoryCache[normalizedDir];
+    textureCache[filePath] = slot;
+    counters.textures++;
+    if (recordLoads)
+    {
+        loadedPaths.push_back(filePath);
+    }
+    return slot;
+}
 
-    // Load all textures
+TextureSlot* TextureManager::cacheUnique(const std::string& filePath, Texture* texture, const uint32_t page,
+                                         const Texture::Config& config, const SpriteTrim::Trim& trim,
+                                         const Hash128& content)
+{
+    if (TextureSlot* shared = sharedSlot(content))
+    {
+        // What another slot for it would have taken
+        alias(filePath, shared, shared->bytes);
+        delete texture;
+        return shared;
+    }
+    return cacheTexture(filePath, texture, page, MipChain::build(texture->image, minMipHeight), config, trim,
+                        content);
+}
+
+TextureSlot* TextureManager::sharedSlot(const Hash128& content) const
+{
+    if (content.isNull())
+    {
+        return nullptr;
+    }
+    const auto it = contentSlots.find(content);
+    return it == contentSlots.end() ? nullptr : it->second;
+}
+
+void TextureManager::alias(const std::string& filePath, TextureSlot* slot, const size_t savedBytes)
+{
+    textureCache[filePath] = slot;
+    slot->aliases.push_back(filePath);
+    counters.duplicates++;
+    counters.duplicateBytes += savedBytes;
+}
+
+bool TextureManager::deduplicating() const
+{
+    // Files of a shared texture could not be reloaded apart
+    return !recordLoads;
+}
+
+void TextureManager::attach(TextureSlot* slot, Texture* texture, const uint32_t page, std::vector<QImage> mips,
+                            const SpriteTrim::Trim& trim)
+{
+    slot->page = page;
+    slot->trim = trim;
+    slot->bytes = page == TextureAtlas::noPage ? static_cast<size_t>(texture->image.sizeInBytes()) : 0;
+    for (QImage& level : mips)
+    {
+        slot->bytes += static_cast<size_t>(level.sizeInBytes());
+        slot->mips.push_back(new Texture{.image = std::move(level), .config = texture->config});
+        // Mips name their texture too, a replay of a capture loads it at full size
+        textureSlots[slot->mips.back()] = slot;
+    }
+    textureSlots[texture] = slot;
+    slot->texture.store(texture, std::memory_order_release);
+    counters.residentBytes += slot->bytes;
+    if (page != TextureAtlas::noPage)
+    {
+        if (pageUsers.size() <= page)
+        {
+            pageUsers.resize(page + 1, 0);
+        }
+        if (pageUsers[page]++ == 0)
+        {
+            counters.residentBytes += static_cast<size_t>(atlas.page(page).sizeInBytes());
+        }
+    }
+}
+
+void TextureManager::detach(TextureSlot* slot, const uint32_t tick)
+{
+    if (!slot->packed.isNull())
+    {
+        // Never drawn from, goes right away
+        counters.packed--;
+        counters.packedBytes -= slot->packed.bytes();
+        counters.unpackedBytes -= expandedBytes(slot->packed);
+        slot->packed = {};
+    }
+    Texture* texture = slot->texture.load(std::memory_order_relaxed);
+    textureSlots.erase(texture);
+    graves.push_back(Grave{texture, TextureAtlas::noPage, tick});
+    for (Texture* mip : slot->mips)
+    {
+        textureSlots.erase(mip);
+        graves.push_back(Grave{mip, TextureAtlas::noPage, tick});
+    }
+    slot->mips.clear();
+    counters.residentBytes -= slot->bytes;
+    if (slot->page != TextureAtlas::noPage && --pageUsers[slot->page] == 0)
+    {
+        // Counted as gone right away so one eviction pass does not empty the whole cache
+        counters.residentBytes -= static_cast<size_t>(atlas.page(slot->page).sizeInBytes());
+        graves.push_back(Grave{nullptr, slot->page, tick});
+        std::erase_if(packPages, [page = slot->page](const auto& entry) { return entry.second == page; });
+    }
+    slot->page = TextureAtlas::noPage;
+    slot->bytes = 0;
+    slot->trim = {};
+}
+
+void TextureManager::evict(TextureSlot* slot, const uint32_t tick)
+{
+    // The pixels go, later loads of the same content must not find them
+    if (!slot->content.isNull())
+    {
+        contentSlots.erase(slot->content);
+        slot->content = {};
+    }
+    textureCache.erase(slot->path);
+    for (const auto& alias : slot->aliases)
+    {
+        textureCache.erase(alias);
+    }
+    slot->aliases.clear();
+    detach(slot, tick);
+    slot->texture.store(nullptr, std::memory_order_relaxed);
+    slot->path.clear();
+    slot->unpackable = false;
+    slot->generation++;
+    counters.textures--;
+    counters.evictions++;
+    freeSlots.push_back(slot);
+}
+
+void TextureManager::reload(const std::vector<std::string>& files)
+{
+    std::lock_guard lock(mutex);
+    // One batch per texture scale, it decides the size files are decoded at
+    std::vector<std::unique_ptr<TextureBatch>> batches;
     for (const auto& file : files)
     {
-        // Check if the texture is already cached
-        if (textureCache.contains(file))
+        const auto it = textureCache.find(file);
+        if (it == textureCache.end())
         {
-            textures.push_back(textureCache[file]);
+            // Not resident, its next load reads the new file anyway
+            continue;
         }
-        else
+        const Texture::Config& config = it->second->config;
+        auto batch = std::find_if(batches.begin(), batches.end(), [&config](const auto& candidate)
         {
-            // Load the texture
-            Texture* texture = loadTexture(file, config);
-            if (texture)
-            {
-                textureCache[file] = texture;
-                textures.push_back(texture);
-            }
+            return candidate->config.scale == config.scale;
+        });
+        if (batch == batches.end())
+        {
+            auto created = std::make_unique<TextureBatch>();
+            created->config = config;
+            created->cache = &diskCache;
+            created->maxHeight = maxHeightFor(config);
+            batch = batches.insert(batches.end(), std::move(created));
         }
+        (*batch)->paths.push_back(file);
     }
+    for (auto& batch : batches)
+    {
+        batch->images.resize(batch->paths.size());
+        batch->mips.resize(batch->paths.size());
+        batch->trims.resize(batch->paths.size());
+        decodeAsync(*batch);
+        reloads.push_back(std::move(batch));
+    }
+}
 
-    return textures;
+void TextureManager::swapReloaded(TextureBatch& batch, const uint32_t tick)
+{
+    for (size_t i = 0; i < batch.paths.size(); i++)
+    {
+        const auto it = textureCache.find(batch.paths[i]);
+        if (it == textureCache.end())
+        {
+            continue;
+        }
+        if (batch.images[i].isNull())
+        {
+            // Caught half written or broken, the texture keeps its pixels until the next save
+            qWarning() << "TextureManager: Failed to reload texture:" << QString::fromStdString(batch.paths[i]);
+            continue;
+        }
+        TextureSlot* slot = it->second;
+        detach(slot, tick);
+        // Leaves its atlas page, the new pixels may not fit the old region
+        auto* texture = new Texture{
+            .image = std::move(batch.images[i]), .config = SpriteTrim::config(slot->config, batch.trims[i])
+        };
+        attach(slot, texture, TextureAtlas::noPage, std::move(batch.mips[i]), batch.trims[i]);
+        counters.reloads++;
+    }
 }
 
-void TextureManager::clearCache()
+std::vector<std::string> TextureManager::takeLoadedPaths()
 {
-    // Delete all cached textures
-    for (auto& [path, texture] : textureCache)
+    std::lock_guard lock(mutex);
+    if (!recordLoads)
     {
-        delete texture;
+        recordLoads = true;
+        for (const auto& [path, slot] : textureCache)
+        {
+            loadedPaths.push_back(path);
+        }
     }
-    textureCache.clear();
-    directoryCache.clear();
+    return std::exchange(loadedPaths, {});
 }
 
-int TextureManager::getTextureCount(const std::string& directory)
+void TextureManager::setBudget(const size_t bytes)
 {
-    // Make sure the directory path is normalized
-    QString qDir = QString::fromStdString(directory);
-    if (!qDir.endsWith('/'))
+    std::lock_guard lock(mutex);
+    counters.budgetBytes = bytes;
+}
+
+void TextureManager::collect(const uint32_t tick, const uint32_t renderedTick)
+{
+    std::lock_guard lock(mutex);
+    TextureSlot::clock.store(tick, std::memory_order_relaxed);
+
+    // Textures go before the pages they view
+    const auto buried = [renderedTick](const Grave& grave) { return grave.tick < renderedTick; };
+    for (const auto& grave : graves)
+    {
+        if (buried(grave))
+        {
+            delete grave.texture;
+        }
+    }
+    for (const auto& grave : graves)
     {
-        qDir += '/';
+        if (buried(grave) && grave.page != TextureAtlas::noPage)
+        {
+            atlas.release(grave.page);
+        }
     }
-    std::string normalizedDir = qDir.toStdString();
+    std::erase_if(graves, buried);
 
-    // Get all files in the directory if not already cached
-    if (directoryCache.find(normalizedDir) == directoryCache.end())
+    // Hot reloads decoded since the last tick, the snapshot published next draws them
+    std::erase_if(reloads, [this, tick](const std::unique_ptr<TextureBatch>& batch)
+    {
+        if (!isDecoded(*batch))
+        {
+            return false;
+        }
+        if (batch->task)
+        {
+            enkiDeleteTaskSet(scheduler, batch->task);
+        }
+        swapReloaded(*batch, tick);
+        return true;
+    });
+
+    packIdle(tick);
+
+    if (counters.residentBytes <= counters.budgetBytes)
+    {
+        return;
+    }
+    std::vector<TextureSlot*> unused;
+    for (auto& slot : slots)
+    {
+        if (slot.texture && slot.references.load(std::memory_order_acquire) == 0)
+        {
+            unused.push_back(&slot);
+        }
+    }
+    std::sort(unused.begin(), unused.end(), [](const TextureSlot* a, const TextureSlot* b)
+    {
+        return a->lastUsed.load(std::memory_order_relaxed) < b->lastUsed.load(std::memory_order_relaxed);
+    });
+    for (TextureSlot* slot : unused)
+    {
+        if (counters.residentBytes <= counters.budgetBytes)
+        {
+            break;
+        }
+        evict(slot, tick);
+    }
+}
+
+void TextureManager::packIdle(const uint32_t tick)
+{
+    const auto idle = [tick](const TextureSlot& slot) { return tick - slot.lastDrawn >= packAfterTicks; };
+    // Frames of a page only go together: the page stays as long as one of them is in use, packing the others
+    // would only add their packed bytes
+    std::vector<bool> pageInUse(pageUsers.size(), false);
+    for (const auto& slot : slots)
     {
-        directoryCache[normalizedDir] = getFilesInDirectory(normalizedDir);
+        if (slot.page != TextureAtlas::noPage && !idle(slot))
+        {
+            pageInUse[slot.page] = true;
+        }
     }
 
-    return static_cast<int>(directoryCache[normalizedDir].size());
+    // A round over the slots spread across ticks, so packing a large load does not make one long tick
+    size_t budget = packBytesPerTick;
+    for (size_t visited = 0; visited < slots.size() && budget > 0; visited++)
+    {
+        packCursor = packCursor + 1 < slots.size() ? packCursor + 1 : 0;
+        TextureSlot& slot = slots[packCursor];
+        Texture* texture = slot.texture.load(std::memory_order_relaxed);
+        if (!texture || slot.unpackable || !slot.packed.isNull() || !idle(slot) ||
+            (slot.page != TextureAtlas::noPage && pageInUse[slot.page]))
+        {
+            continue;
+        }
+        budget -= std::min(budget, static_cast<size_t>(texture->image.sizeInBytes()));
+        SpriteCodec::Packed packed = SpriteCodec::pack(texture->image);
+        if (packed.isNull() || packed.bytes() * 2 > expandedBytes(packed))
+        {
+            // Noisy pixels, not worth expanding on every draw
+            slot.unpackable = true;
+            continue;
+        }
+        const Texture::Config config = texture->config;
+        const SpriteTrim::Trim trim = slot.trim;
+        detach(&slot, tick);
+        attach(&slot, new Texture{.image = QImage(), .config = config}, TextureAtlas::noPage, {}, trim);
+        slot.bytes += packed.bytes();
+        counters.residentBytes += packed.bytes();
+        counters.packed++;
+        counters.packedBytes += packed.bytes();
+        counters.unpackedBytes += expandedBytes(packed);
+        slot.packed = std::move(packed);
+    }
 }
 
-Texture* TextureManager::loadTexture(const std::string& filePath, const Texture::Config& config)
+void TextureManager::expand(TextureSlot* slot)
 {
-    QImage image(QString::fromStdString(filePath));
-    if (image.isNull())
+    std::lock_guard lock(mutex);
+    if (slot->packed.isNull())
     {
-        qWarning() << "TextureManager: Failed to load texture:" << QString::fromStdString(filePath);
-        return nullptr;
+        return;
     }
+    QImage image = SpriteCodec::expand(slot->packed);
+    std::vector<QImage> mips = MipChain::build(image, minMipHeight);
+    const Texture::Config config = slot->texture.load(std::memory_order_relaxed)->config;
+    const SpriteTrim::Trim trim = slot->trim;
+    // Back on an image of its own, the atlas page it came from may be gone
+    detach(slot, TextureSlot::clock.load(std::memory_order_relaxed));
+    attach(slot, new Texture{.image = std::move(image), .config = config}, TextureAtlas::noPage, std::move(mips),
+           trim);
+    counters.expansions++;
+}
 
-    // Create a new texture (1 frame, raw size, scale 1.0)
-    return new Texture{.image = image, .config = config};
+void TextureHandle::expand(TextureSlot* slot)
+{
+    TextureManager::getInstance().expand(slot);
 }
 
-bool TextureManager::compareFilenames(const QString& a, const QString& b)
+void TextureManager::setDisplayDensity(const float pixelsPerUnit)
 {
-    // Try to extract numbers from filenames for natural sorting
-    QRegularExpression re("(\\d+)");
+    std::lock_guard lock(mutex);
+    displayDensity = pixelsPerUnit;
+}
 
-    // Extract the base name without path or extension
-    QString baseA = QFileInfo(a).completeBaseName();
-    QString baseB = QFileInfo(b).completeBaseName();
+int TextureManager::maxHeightFor(const Texture::Config& config) const
+{
+    return displayDensity > 0 ? static_cast<int>(std::ceil(config.scale * displayDensity)) : 0;
+}
 
-    // Try to find numbers in the filenames
-    auto matchA = re.match(baseA);
-    auto matchB = re.match(baseB);
+void TextureManager::setDiskCache(const std::string& directory)
+{
+    std::lock_guard lock(mutex);
+    diskCache.setDirectory(directory);
+}
 
-    // If both have numbers, compare numerically
-    if (matchA.hasMatch() && matchB.hasMatch())
+TextureManager::Stats TextureManager::stats() const
+{
+    std::lock_guard lock(mutex);
+    Stats stats = counters;
+    stats.diskHits = diskCache.hits();
+    stats.diskMisses = diskCache.misses();
+    return stats;
+}
+
+bool TextureManager::openManifest(const std::string& path)
+{
+    std::lock_guard lock(mutex);
+    directoryCache.clear();
+    // Listings may change, frames are bound again by index on their next request
+    for (auto& asset : assets)
     {
-        int numA = matchA.captured(1).toInt();
-        int numB = matchB.captured(1).toInt();
-        return numA < numB;
+        asset.frames.clear();
     }
+    return manifest.open(path);
+}
 
-    // Otherwise, compare lexicographically
-    return a < b;
+bool TextureManager::openPack(const std::string& path)
+{
+    // Cached textures may view pages of the previous pack
+    clearCache();
+    std::lock_guard lock(mutex);
+    return pack.open(path);
 }
 
-std::vector<std::string> TextureManager::getFilesInDirectory(const std::string& directory)
+Texture* TextureManager::loadPackedTexture(const std::string& filePath, const Texture::Config& config, uint32_t& page,
+                                           SpriteTrim::Trim& trim, Hash128& content)
 {
-    std::vector<std::string> filePaths;
+    page = TextureAtlas::noPage;
+    if (!pack.isOpen())
+    {
+        return nullptr;
+    }
+    const AssetPack::Frame* frame = pack.frame(filePath);
+    if (!frame)
+    {
+        return nullptr;
+    }
+    // The cooker trimmed the frame already, and pointed repeated frames at the same pixels: their place in the
+    // pack is their content
+    trim = frame->trim;
+    if (deduplicating())
+    {
+        const auto scale = static_cast<float>(config.scale);
+        const int32_t place[] = {
+            static_cast<int32_t>(frame->record), frame->rect.x(), frame->rect.y(), frame->rect.width(),
+            frame->rect.height(), trim.canvas.width(), trim.canvas.height(), trim.rect.x(), trim.rect.y()
+        };
+        content = Hash128::of(place, sizeof(place), std::bit_cast<uint32_t>(scale));
+    }
+    const Texture::Config trimmed = SpriteTrim::config(config, trim);
+    if (!pack.isPage(frame->record))
+    {
+        QImage image = pack.record(frame->record);
+        return image.isNull() ? nullptr : new Texture{.image = std::move(image), .config = trimmed};
+    }
 
-    namespace fs = std::filesystem;
-    fs::path dirPath(directory);
+    auto packPage = packPages.find(frame->record);
+    if (packPage == packPages.end())
+    {
+        const QImage image = pack.record(frame->record);
+        if (image.isNull())
+        {
+            return nullptr;
+        }
+        packPage = packPages.emplace(frame->record, atlas.adopt(image)).first;
+    }
+    page = packPage->second;
+    return new Texture{.image = atlas.view(atlas.region(page, frame->rect)), .config = trimmed};
+}
+
+Texture::Config TextureManager::getTextureConfig(const Texture* texture) const
+{
+    std::lock_guard lock(mutex);
+    const auto it = textureSlots.find(texture);
+    return it == textureSlots.end() ? texture->config : it->second->config;
+}
+
+SpriteTrim::Trim TextureManager::getTrim(const Texture* texture) const
+{
+    std::lock_guard lock(mutex);
+    const auto it = textureSlots.find(texture);
+    // Only the current texture of a slot, mips and reloaded versions still drawn are not asked for
+    return it == textureSlots.end() || it->second->texture.load(std::memory_order_relaxed) != texture
+               ? SpriteTrim::Trim()
+               : it->second->trim;
+}
+
+std::string TextureManager::getTexturePath(const Texture* texture) const
+{
+    std::lock_guard lock(mutex);
+    const auto it = textureSlots.find(texture);
+    return it == textureSlots.end() ? std::string() : it->second->path;
+}
+
+int TextureManager::getTextureCount(const std::string& directory)
+{
+    std::lock_guard lock(mutex);
+    return static_cast<int>(listDirectory(directory).size());
+}
+
+int TextureManager::getTextureCount(const AssetId directory)
+{
+    std::lock_guard lock(mutex);
+    const Asset& asset = assets[resolve(directory)];
+    return asset.frames.empty()
+               ? static_cast<int>(listDirectory(asset.directory).size())
+               : static_cast<int>(asset.frames.size());
+}
 
-    if (!fs::exists(dirPath))
+Texture* TextureManager::loadTexture(const std::string& filePath, const Texture::Config& config, uint32_t& page,
+                                     SpriteTrim::Trim& trim, Hash128& content)
+{
+    if (Texture* texture = loadPackedTexture(filePath, config, page, trim, content))
     {
-        std::cerr << "TextureManager: Directory does not exist: " << directory << std::endl;
-        return filePaths;
+        return texture;
+    }
+    QImage image = diskCache.load(filePath, config);
+    if (image.isNull())
+    {
+        qWarning() << "TextureManager: Failed to load texture:" << QString::fromStdString(filePath);
+        return nullptr;
     }
+    image = MipChain::fitHeight(image, maxHeightFor(config));
+    trim = SpriteTrim::trim(image);
+    if (deduplicating())
+    {
+        content = contentOf(image, config, trim);
+    }
+
+    // Create a new texture (1 frame, raw size, scale 1.0)
+    return new Texture{.image = image, .config = SpriteTrim::config(config, trim)};
+}
 
-    // Get all files with supported extensions
-    for (const auto& entry : fs::directory_iterator(dirPath))
+std::vector<std::string> TextureManager::getFilesInDirectory(const std::string& directory)
+{
+    if (pack.isOpen())
+    {
+        if (const auto files = pack.directory(directory))
+        {
+            return *files;
+        }
+    }
+    if (manifest.isOpen())
+    {
+        if (const auto files = manifest.listing(directory))
+        {
+            return *files;
+        }
+    }
+    if (directory.size() > 1 && !FileUtils::directoryExists(directory))
     {
-        if (entry.is_regular_file())
+        // Not a directory, maybe a clip: the frames of its parent whose names start like it
+        const std::string name = directory.substr(0, directory.size() - 1);
+        const size_t slash = name.find_last_of('/');
+        if (slash != std::string::npos && FileUtils::directoryExists(name.substr(0, slash + 1)))
         {
-            std::string ext = entry.path().extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-            if (ext == ".png" || ext == ".jpg" || ext == ".jpeg")
+            std::vector<std::string> frames = FileUtils::listImages(name.substr(0, slash + 1));
+            std::erase_if(frames, [clip = name.substr(slash + 1)](const std::string& file)
             {
-                filePaths.push_back(entry.path().string());
-            }
+                return FileUtils::clipFrame(file).clip != clip;
+            });
+            return frames;
         }
     }
-
-    // Sort filenames using natural sorting
-    std::sort(filePaths.begin(), filePaths.end(),
-              [](const std::string& a, const std::string& b)
-              {
-                  return compareFilenames(QString::fromStdString(a), QString::fromStdString(b));
-              });
-
-    return filePaths;
+    return FileUtils::listImages(directory);
 }
@@ -8,44 +8,317 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
 #include "Texture.h"
+#include "AssetId.h"
+#include "AssetManifest.h"
+#include "AssetPack.h"
+#include "DecodeCache.h"
+#include "TextureHandle.h"
+#include "../Render/TextureAtlas.h"
+#include "../Utils/Hash128.h"
 #include "../Utils/Singletion.h"
+#include "TaskScheduler_c.h"
+
+// Decode work of one directory load, defined in TextureManager.cpp
+struct TextureBatch;
+
+/*
+    Textures of a directory being decoded on the TextureManager workers, from TextureManager::loadAllTextures().
+    wait() lends the calling thread to the decoding, then inserts the textures into the cache and returns them in
+    file order. Waits in its destructor, so must not outlive the manager.
+*/
+class TextureFuture
+{
+public:
+    TextureFuture();
+    TextureFuture(TextureFuture&& other) noexcept;
+    TextureFuture& operator=(TextureFuture&& other) noexcept;
+    ~TextureFuture();
+
+    // Every image is decoded, wait() only has the cache insert left to do
+    bool ready() const;
+
+    const std::vector<TextureHandle>& wait();
+
+private:
+    friend class TextureManager;
+
+    std::unique_ptr<TextureBatch> batch;
+    std::vector<TextureHandle> textures;
+};
 
 class TextureManager final : public  Singleton<TextureManager>{
+public:
+    constexpr static size_t defaultBudget = size_t{512} << 20;
+
+    struct Stats
+    {
+        // Own images plus atlas pages with a texture on them
+        size_t residentBytes = 0;
+        size_t budgetBytes = defaultBudget;
+        size_t textures = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        // Decodes served by and missing from the on-disk cache
+        uint64_t diskHits = 0;
+        uint64_t diskMisses = 0;
+        // Textures swapped for a newer version of their file
+        uint64_t reloads = 0;
+        // Files served by the texture of another file with the same pixels, and the bytes that saved
+        uint64_t duplicates = 0;
+        size_t duplicateBytes = 0;
+        // Textures held packed, the bytes they take (part of residentBytes) and would take expanded, without mips
+        size_t packed = 0;
+        size_t packedBytes = 0;
+        size_t unpackedBytes = 0;
+        // Packed textures expanded again to be drawn
+        uint64_t expansions = 0;
+    };
+
 private:
+    // Guards everything below, textures are requested from the simulation and the GUI thread
+    mutable std::mutex mutex;
+
+    // Slot of every resident texture, addresses stay put so handles can point at them
+    std::deque<TextureSlot> slots;
+    std::vector<TextureSlot*> freeSlots;
+    // Last TextureSlot::id given
+    uint32_t lastSlotId = 0;
+
     // Cache of loaded textures by path
-    std::unordered_map<std::string, Texture*> textureCache;
+    std::unordered_map<std::string, TextureSlot*> textureCache;
+
+    // Reverse lookup of textureCache, used to name textures outside the process
+    std::unordered_map<const Texture*, TextureSlot*> textureSlots;
+
+    // Slot of every resident texture by content, files with the same content share it
+    std::unordered_map<Hash128, TextureSlot*, Hash128::Hasher> contentSlots;
+
+    // Pages holding the frames of every loaded directory
+    TextureAtlas atlas;
+    // Resident textures on each page, a page is freed with its last texture
+    std::vector<uint32_t> pageUsers;
+
+    // Cooked assets, consulted before the filesystem when open
+    AssetPack pack;
+    // Atlas page of every pack record already adopted
+    std::unordered_map<uint32_t, uint32_t> packPages;
+
+    // Decoded pixels of files loaded from disk, kept between runs
+    DecodeCache diskCache;
+
+    // Screen pixels per world unit at the closest zoom, 0 when unknown
+    float displayDensity = 0;
+    // Levels stop before they get smaller than this
+    constexpr static int minMipHeight = 8;
+
+    // Directory and clip listings prebuilt by lucknight_cook --manifest, consulted before the filesystem when open
+    AssetManifest manifest;
 
     // Cache of directories and their contents
     std::unordered_map<std::string, std::vector<std::string>> directoryCache;
 
-    // Sort files in a directory by name
-    std::vector<std::string> getFilesInDirectory(const std::string& directory);
+    // Directories and clips requested by AssetId, entries are never removed so their indices stay valid
+    struct Asset
+    {
+        std::string directory;
+        // Slot of every frame and its generation when bound, empty until the frames are first loaded
+        std::vector<std::pair<TextureSlot*, uint32_t>> frames;
+    };
+    std::vector<Asset> assets;
+    std::unordered_map<entt::id_type, uint32_t> assetIndices;
+
+    // Evicted textures and emptied pages, freed once the renderer has moved past the tick they were evicted on
+    struct Grave
+    {
+        Texture* texture;
+        uint32_t page;
+        uint32_t tick;
+    };
+    std::vector<Grave> graves;
+
+    // Changed files decoding on the workers, swapped in by collect() once decoded
+    std::vector<std::unique_ptr<TextureBatch>> reloads;
+
+    // Paths cached since the last takeLoadedPaths(), recorded once a watcher asked for them
+    std::vector<std::string> loadedPaths;
+    bool recordLoads = false;
+
+    Stats counters;
+
+    // Textures not drawn for this many ticks are packed, their atlas page once all its textures are
+    constexpr static uint32_t packAfterTicks = 120;
+    // Bytes of pixels packed per tick at most
+    constexpr static size_t packBytesPerTick = size_t{8} << 20;
+    // Slot packIdle() carries on from
+    size_t packCursor = 0;
 
-    // Helper to get filenames in a directory sorted properly
-    static bool compareFilenames(const QString& a, const QString& b);
+    // Decodes images, the thread creating the manager and up to maxLoadingThreads others may load textures in
+    // parallel, any further thread decodes on its own
+    constexpr static uint32_t maxLoadingThreads = 4;
+    enkiTaskScheduler* scheduler;
+    std::thread::id schedulerThread;
+
+    // Files of a directory or frames of a clip, in natural order
+    std::vector<std::string> getFilesInDirectory(const std::string& directory);
 
     // Load a texture from file
-    Texture* loadTexture(const std::string& filePath, const Texture::Config& config);
+    Texture* loadTexture(const std::string& filePath, const Texture::Config& config, uint32_t& page,
+                         SpriteTrim::Trim& trim, Hash128& content);
+
+    // Collects the files not cached yet into a batch, textures of the pack are cached right away. Lock held
+    std::unique_ptr<TextureBatch> prepareBatch(const std::vector<std::string>& files, const Texture::Config& config);
+
+    // Hands the images of the batch to the workers
+    TextureFuture startBatch(std::unique_ptr<TextureBatch> batch);
+
+    // Starts a task decoding the batch, or decodes it right away when this thread cannot take part
+    void decodeAsync(TextureBatch& batch);
+
+    // Puts the decoded images of a reload batch behind the slots of their files
+    void swapReloaded(TextureBatch& batch, uint32_t tick);
+
+    // Waits for the decoding and caches the images, packed together into atlas pages
+    std::vector<TextureHandle> finishBatch(TextureBatch& batch);
+
+    bool isDecoded(const TextureBatch& batch) const;
+
+    // Height a texture loaded from disk is halved down to but not below, 0 for no limit
+    int maxHeightFor(const Texture::Config& config) const;
+
+    // Registers the calling thread with the scheduler if needed, false when it cannot take part
+    bool joinScheduler() const;
+
+    static void decodeImages(uint32_t start, uint32_t end, uint32_t threadIndex, void* args);
+
+    friend class TextureFuture;
+    friend class TextureHandle;
+
+    // Texture for a frame of the pack, nullptr if the pack does not hold the file
+    Texture* loadPackedTexture(const std::string& filePath, const Texture::Config& config, uint32_t& page,
+                               SpriteTrim::Trim& trim, Hash128& content);
+
+    // Insert a loaded texture into the caches, config as requested and the border trimmed off it. A null content
+    // is never shared
+    TextureSlot* cacheTexture(const std::string& filePath, Texture* texture, uint32_t page, std::vector<QImage> mips,
+                              const Texture::Config& config, const SpriteTrim::Trim& trim, const Hash128& content);
+
+    // cacheTexture(), or the resident texture with the same content, in which case texture is deleted
+    TextureSlot* cacheUnique(const std::string& filePath, Texture* texture, uint32_t page,
+                             const Texture::Config& config, const SpriteTrim::Trim& trim, const Hash128& content);
+
+    // Resident slot with the content, nullptr for none or a null content
+    TextureSlot* sharedSlot(const Hash128& content) const;
+
+    // Serves a file with the texture of another, savedBytes its own copy would have taken
+    void alias(const std::string& filePath, TextureSlot* slot, size_t savedBytes);
+
+    // Identical textures are shared unless hot reload is on: files sharing one could not be reloaded apart
+    bool deduplicating() const;
+
+    // Cached texture of a path, counting the hit or miss
+    TextureSlot* lookup(const std::string& filePath);
+
+    const std::vector<std::string>& listDirectory(const std::string& directory);
+
+    void evict(TextureSlot* slot, uint32_t tick);
+
+    // Makes texture and its mips the content of a slot, accounting their bytes and page
+    void attach(TextureSlot* slot, Texture* texture, uint32_t page, std::vector<QImage> mips,
+                const SpriteTrim::Trim& trim);
+
+    // Buries the texture and mips of a slot, to be freed once the renderer is past tick. Drops its packed pixels
+    void detach(TextureSlot* slot, uint32_t tick);
+
+    // Packs the pixels of textures that have not been drawn for a while, an empty image takes their place
+    void packIdle(uint32_t tick);
+
+    // Puts the pixels of a packed texture back on an image of its own, called by TextureHandle::pixels()
+    void expand(TextureSlot* slot);
+
+    // Index of the asset table entry of an id, registered on first use
+    uint32_t resolve(AssetId id);
+
+    // Points the frames of an asset at the cached slots of its files
+    void bindFrames(Asset& asset);
+
+    // Cached frame of an asset without any lookup, nullptr if it was never bound or has been evicted since
+    TextureSlot* boundFrame(const Asset& asset, int index) const;
 
 public:
+    TextureManager();
     ~TextureManager() override;
-    // Get a texture by directory and index
-    Texture* getTextures(const std::string& directory, int index, const Texture::Config& config);
-    Texture* getTexture(const std::string& file, const Texture::Config& config);
+    // Serve textures from a pack written by lucknight_cook, files missing from it are still loaded from disk
+    bool openPack(const std::string& path);
+
+    // List directories and clips from a manifest written by lucknight_cook --manifest instead of the filesystem
+    bool openManifest(const std::string& path);
+
+    // Get a texture by directory and index. The directory may also name a clip, the frames of a directory sharing
+    // a name up to their frame number (assets/特效/alchemist_0_skill_2_effect_0)
+    TextureHandle getTextures(const std::string& directory, int index, const Texture::Config& config);
+    TextureHandle getTexture(const std::string& file, const Texture::Config& config);
+
+    // Same as above for a hashed name: once the frame is cached this is an array index, no string is built or hashed
+    TextureHandle getTextures(AssetId directory, int index, const Texture::Config& config);
 
     // Get all textures in a directory
-    std::vector<Texture*> getAllTextures(const std::string& directory, const Texture::Config& config);
+    std::vector<TextureHandle> getAllTextures(const std::string& directory, const Texture::Config& config);
+    std::vector<TextureHandle> getAllTextures(AssetId directory, const Texture::Config& config);
+
+    // Starts decoding the textures of a directory across the workers and returns without waiting for them
+    TextureFuture loadAllTextures(const std::string& directory, const Texture::Config& config);
+
+    // Path a cached texture was loaded from, empty for textures not owned by the manager
+    std::string getTexturePath(const Texture* texture) const;
+
+    // Config a cached texture was requested with. Trimmed textures have a smaller scale of their own, loading
+    // the path again takes this one. The texture's own config for textures not owned by the manager
+    Texture::Config getTextureConfig(const Texture* texture) const;
+
+    // Transparent border cut off a cached texture, untrimmed for textures not owned by the manager
+    SpriteTrim::Trim getTrim(const Texture* texture) const;
+
+    // Bytes of textures to keep resident, unreferenced textures are evicted least recently used first above it
+    void setBudget(size_t bytes);
+
+    // Called once per tick by the simulation: packs textures not drawn for a while, evicts down to the budget and
+    // frees what was evicted or packed before renderedTick, the tick of the oldest snapshot the renderer may still
+    // be drawing
+    void collect(uint32_t tick, uint32_t renderedTick);
+
+    Stats stats() const;
+
+    // Decodes the files again on the workers and swaps the new pixels in behind the handles of their textures at
+    // the next collect(). Files that are not resident are skipped
+    void reload(const std::vector<std::string>& files);
+
+    // Files cached since the last call, every resident one on the first call. Turns deduplication off from then on,
+    // call it before loading to reload every file on its own
+    std::vector<std::string> takeLoadedPaths();
+
+    // Files loaded from disk afterwards are downsampled to no fewer than a texel per pixel on a screen showing
+    // pixelsPerUnit pixels per world unit. Every texture also gets a mip chain, see TextureHandle::level()
+    void setDisplayDensity(float pixelsPerUnit);
+
+    // Keep decoded pixels of files loaded from disk in the directory, empty to stop. Before any texture is loaded
+    void setDiskCache(const std::string& directory);
 
-    // Clear texture cache
+    // Clear texture cache, no handle may outlive it
     void clearCache();
 
     // Get texture frame count in a directory
     int getTextureCount(const std::string& directory);
+    int getTextureCount(AssetId directory);
 };
 
 #endif //TEXTUREMANAGER_H
@@ -10,7 +10,7 @@
 #include "../Components/Transform.h"
 #include "entt/entity/registry.hpp"
 
-entt::entity Prefab::build(const Matrix &transform) {
+entt::entity Prefab::build(const Transform &transform) {
     auto &registry = World::getInstance().registry;
     const auto entity = registry.create();
     registry.emplace<Transform>(entity, transform);
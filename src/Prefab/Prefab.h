@@ -4,7 +4,7 @@
 
 #ifndef PREFAB_H
 #define PREFAB_H
-#include "../Type/Matrix.h"
+#include "../Components/Transform.h"
 #include "entt/entt.hpp"
 
 
@@ -12,7 +12,7 @@ class Prefab {
 public:
     virtual ~Prefab() {
     };
-    virtual entt::entity build(const Matrix &transform = Matrix());
+    virtual entt::entity build(const Transform &transform = Transform());
 };
 
 
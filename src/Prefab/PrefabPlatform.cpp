@@ -11,7 +11,7 @@
 #include "../Components/Types.h"
 #include "../Managers/TextureManager.h"
 
-inline entt::entity PrefabPlatform::build(const Matrix& transform)
+inline entt::entity PrefabPlatform::build(const Transform& transform)
 {
     const auto entity = Prefab::build(transform);
     auto& registry = World::getInstance().registry;
@@ -35,12 +35,15 @@ inline entt::entity PrefabPlatform::build(const Matrix& transform)
     return entity;
 }
 
-entt::entity PrefabPlatform::build(const Matrix& transform, int imageIndex)
+entt::entity PrefabPlatform::build(const Transform& transform, int imageIndex)
 {
+    // Hashed at compile time, spawning indexes the manager's asset table
+    constexpr AssetId platformTextures("assets/platform/static");
     auto& registry = World::getInstance().registry;
     const auto entity = build(transform);
     registry.emplace<Drawable>(entity, Drawable{
-                                   .texture = TextureManager::getInstance().getTextures("assets/platform/static", imageIndex, {})
+                                   .texture = TextureManager::getInstance().getTextures(platformTextures, imageIndex, {})
                                });
+    registry.emplace<TagStaticSprite>(entity);
     return entity;
 }
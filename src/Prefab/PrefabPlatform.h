@@ -9,9 +9,9 @@
 
 class PrefabPlatform : public Prefab{
 protected:
-    entt::entity build(const Matrix& transform) override;
+    entt::entity build(const Transform& transform) override;
 public:
-    entt::entity build(const Matrix& transform,int imageIndex);
+    entt::entity build(const Transform& transform,int imageIndex);
 };
 
 
@@ -17,12 +17,13 @@
 #include "../Components/Types.h"
 #include "../Events/KeyEvents.h"
 #include "../Managers/EventManager.h"
+#include "../Managers/TextureManager.h"
 #include "../Scripts/PlayerScript.h"
 
 #include "../Systems/AnimationSystem.h"
 
 
-entt::entity PrefabPlayer::build(const Matrix& transform)
+entt::entity PrefabPlayer::build(const Transform& transform)
 {
     const auto entity = Prefab::build(transform);
     auto& registry = World::getInstance().registry;
@@ -45,11 +46,20 @@ entt::entity PrefabPlayer::build(const Matrix& transform)
     registry.emplace<Keymap>(entity, Keymap{Key::Key_A, Key::Key_D, Key::Key_W, Key::Key_S, Key::Key_F});
     registry.emplace<Input>(entity);
     registry.emplace<StatusPlayer>(entity,StatusPlayer{.health = 100,.move_force = 25.0f,.jump_impulse = 6.0f,});
-    registry.emplace<Drawable>(entity, Drawable{.texture = nullptr});
+    registry.emplace<StatusBuff>(entity);
+    registry.emplace<Drawable>(entity, Drawable{});
     registry.emplace<Animator>(entity);
     registry.emplace<PlayerScript>(entity);
     registry.emplace<GroundDetector>(entity, GroundDetector{.offset = {0, -halfHeight}});
 
+    {
+        // Both clips decode side by side, the registrations below then find them cached
+        auto& textures = TextureManager::getInstance();
+        TextureFuture idle = textures.loadAllTextures("assets/player/idle", {.scale = 2 * halfHeight});
+        TextureFuture move = textures.loadAllTextures("assets/player/move", {.scale = 2 * halfHeight});
+        idle.wait();
+        move.wait();
+    }
     AnimationSystem::getInstance().registerAnimation<PlayerScript::PlayerStateMachine::Idle>(
         entity, "assets/player/idle", {.scale = 2 * halfHeight});
     AnimationSystem::getInstance().registerAnimation<PlayerScript::PlayerStateMachine::Moving>(
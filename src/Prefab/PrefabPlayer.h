@@ -11,7 +11,7 @@ class PrefabPlayer: public Prefab{
 
 public:
     ~PrefabPlayer() override = default;
-    entt::entity build(const Matrix &transform = Matrix()) override;
+    entt::entity build(const Transform &transform = Transform()) override;
 private:
     // Initialize animations for the player entity
 };
@@ -16,7 +16,7 @@
 #include "../Managers/TextureManager.h"
 
 
-entt::entity PrefabProjectile::build(const Matrix& transform)
+entt::entity PrefabProjectile::build(const Transform& transform)
 {
     auto& registry = World::getInstance().registry;
     const auto entity = Prefab::build(transform);
@@ -35,8 +35,9 @@ entt::entity PrefabProjectile::build(const Matrix& transform)
 
                                           });
 
-    Texture* texture = TextureManager::getInstance().getTextures("assets/projectile/", 0, {.scale = 0.4});
-    registry.emplace<Drawable>(entity, Drawable{.texture = texture});
+    constexpr AssetId projectileTextures("assets/projectile");
+    TextureHandle texture = TextureManager::getInstance().getTextures(projectileTextures, 0, {.scale = 0.4});
+    registry.emplace<Drawable>(entity, Drawable{.texture = std::move(texture)});
 
     registry.emplace<StatusProjectile>(entity, StatusProjectile{.damage = 10, .lifeLeft = 10.0f});
     registry.emplace<ProjectileScript>(entity);
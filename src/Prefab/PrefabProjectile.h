@@ -10,7 +10,7 @@
 class PrefabProjectile : Prefab
 {
 public:
-    entt::entity build(const Matrix& transform) override;
+    entt::entity build(const Transform& transform) override;
 };
 
 
@@ -0,0 +1,177 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "DrawCapture.h"
+
+#include <bit>
+#include <cassert>
+#include <QBuffer>
+#include <QtEndian>
+
+#include "DrawStream.h"
+#include "TransformKernel.h"
+#include "../Managers/TextureManager.h"
+
+namespace
+{
+    void append(QByteArray& out, uint32_t value)
+    {
+        value = qToLittleEndian(value);
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void append(QByteArray& out, const float value)
+    {
+        append(out, std::bit_cast<uint32_t>(value));
+    }
+}
+
+DrawCapture::DrawCapture(QIODevice* device): device(device)
+{
+    assert(device && device->isWritable());
+    QByteArray header;
+    append(header, DrawStream::fileMagic);
+    append(header, DrawStream::version);
+    bytes += device->write(header);
+}
+
+void DrawCapture::setRange(const uint32_t first, const uint32_t count)
+{
+    this->first = first;
+    this->count = count;
+}
+
+bool DrawCapture::finished() const
+{
+    return written >= count;
+}
+
+uint32_t DrawCapture::framesWritten() const
+{
+    return written;
+}
+
+uint64_t DrawCapture::bytesWritten() const
+{
+    return bytes;
+}
+
+void DrawCapture::beginFrame(RenderBackend& target, const uint32_t tick, const float zoom, const float aspect)
+{
+    this->target = &target;
+    recording = frame >= first && !finished();
+    if (recording)
+    {
+        this->tick = tick;
+        this->zoom = zoom;
+        this->aspect = aspect;
+        definitions.clear();
+        draws.clear();
+        definitionCount = 0;
+        drawCount = 0;
+    }
+}
+
+void DrawCapture::endFrame()
+{
+    assert(target);
+    target = nullptr;
+    frame++;
+    if (!recording)
+    {
+        return;
+    }
+    recording = false;
+
+    QByteArray header;
+    header.reserve(DrawStream::frameHeaderSize);
+    append(header, DrawStream::frameMagic);
+    append(header, tick);
+    append(header, zoom);
+    append(header, aspect);
+    append(header, definitionCount);
+    append(header, drawCount);
+    bytes += device->write(header + definitions + draws);
+    written++;
+}
+
+void DrawCapture::draw(Texture& texture, const float* matrix, const SpriteColor& color)
+{
+    assert(target);
+    if (recording)
+    {
+        record(textureId(texture), matrix, color);
+    }
+    target->draw(texture, matrix, color);
+}
+
+void DrawCapture::drawRun(Texture& texture, const float* matrices, const SpriteColor* colors, const size_t count)
+{
+    assert(target);
+    if (recording)
+    {
+        const uint32_t id = textureId(texture);
+        for (size_t i = 0; i < count; i++)
+        {
+            record(id, matrices + i * TransformKernel::matrixSize, colors[i]);
+        }
+    }
+    target->drawRun(texture, matrices, colors, count);
+}
+
+uint32_t DrawCapture::textureId(const Texture& texture)
+{
+    // Chunk textures are freed and reallocated, an address alone does not name a texture
+    const auto [it, inserted] = textureIds.try_emplace(&texture, TextureEntry{nextId, texture.image.cacheKey()});
+    if (!inserted && it->second.imageKey == texture.image.cacheKey())
+    {
+        return it->second.id;
+    }
+    if (!inserted)
+    {
+        it->second = TextureEntry{nextId, texture.image.cacheKey()};
+    }
+    const uint32_t id = nextId++;
+
+    QByteArray payload;
+    auto kind = DrawStream::TextureKind::Path;
+    if (const std::string path = TextureManager::getInstance().getTexturePath(&texture); !path.empty())
+    {
+        payload = QByteArray::fromStdString(path);
+    }
+    else
+    {
+        kind = DrawStream::TextureKind::Image;
+        QBuffer buffer(&payload);
+        buffer.open(QIODevice::WriteOnly);
+        texture.image.save(&buffer, "PNG");
+    }
+    append(definitions, id);
+    // Loading the path again trims the texture again, it takes the scale it was requested with
+    append(definitions, static_cast<float>(kind == DrawStream::TextureKind::Path
+                                               ? TextureManager::getInstance().getTextureConfig(&texture).scale
+                                               : texture.config.scale));
+    definitions.append(static_cast<char>(kind));
+    append(definitions, static_cast<uint32_t>(payload.size()));
+    definitions.append(payload);
+    definitionCount++;
+    return id;
+}
+
+void DrawCapture::record(const uint32_t id, const float* matrix, const SpriteColor& color)
+{
+    // Render matrices are 2D affine plus depth, the other terms are constant
+    append(draws, id);
+    append(draws, matrix[0]);
+    append(draws, matrix[1]);
+    append(draws, matrix[3]);
+    append(draws, matrix[4]);
+    append(draws, matrix[5]);
+    append(draws, matrix[7]);
+    append(draws, matrix[11]);
+    append(draws, color.multiply);
+    append(draws, color.tint);
+    append(draws, static_cast<uint32_t>(color.flash));
+    drawCount++;
+}
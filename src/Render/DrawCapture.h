@@ -0,0 +1,73 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef DRAWCAPTURE_H
+#define DRAWCAPTURE_H
+#include <cstdint>
+#include <unordered_map>
+#include <QByteArray>
+#include <QIODevice>
+
+#include "RenderBackend.h"
+
+/*
+    Records the draw stream of Scene::render into a DrawStream file while passing it on to the real backend.
+    Only the frames in the capture range are written, one device write per frame. The file is read back by
+    DrawStreamReader, see lucknight_replay_draws.
+*/
+class DrawCapture final : public RenderBackend
+{
+public:
+    explicit DrawCapture(QIODevice* device);
+
+    // Record frameCount frames starting at the first-th frame drawn through the capture
+    void setRange(uint32_t first, uint32_t count);
+
+    // Every draw until endFrame() goes to target, zoom and aspect describe the camera of the frame
+    void beginFrame(RenderBackend& target, uint32_t tick, float zoom, float aspect);
+    void endFrame();
+
+    void draw(Texture& texture, const float* matrix, const SpriteColor& color) override;
+    void drawRun(Texture& texture, const float* matrices, const SpriteColor* colors, size_t count) override;
+
+    // The whole range has been written
+    bool finished() const;
+    uint32_t framesWritten() const;
+    uint64_t bytesWritten() const;
+
+private:
+    struct TextureEntry
+    {
+        uint32_t id;
+        // QImage::cacheKey when the id was given, a texture whose image changed is defined again
+        qint64 imageKey;
+    };
+
+    QIODevice* device;
+    RenderBackend* target = nullptr;
+    uint32_t first = 0;
+    uint32_t count = UINT32_MAX;
+    uint32_t frame = 0;
+    uint32_t written = 0;
+    uint64_t bytes = 0;
+    bool recording = false;
+
+    std::unordered_map<const Texture*, TextureEntry> textureIds;
+    uint32_t nextId = 0;
+
+    // Current frame, written out by endFrame()
+    QByteArray definitions;
+    QByteArray draws;
+    uint32_t definitionCount = 0;
+    uint32_t drawCount = 0;
+    uint32_t tick = 0;
+    float zoom = 0;
+    float aspect = 0;
+
+    uint32_t textureId(const Texture& texture);
+    void record(uint32_t id, const float* matrix, const SpriteColor& color);
+};
+
+
+#endif //DRAWCAPTURE_H
@@ -0,0 +1,48 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef DRAWSTREAM_H
+#define DRAWSTREAM_H
+#include <cstdint>
+
+/*
+    File layout of a draw capture, all fields little endian:
+        file header   magic, version
+        frame         FrameHeader, then definitionCount texture definitions, then drawCount draws
+        definition    id u32, scale f32, kind u8, size u32, size bytes (the TextureManager path or a PNG)
+        draw          id u32, the six affine terms and z of the render matrix as f32,
+                      SpriteColor multiply u32, tint u32, flash u32
+    A texture is defined in the first frame that draws it. Its id stays valid for the rest of the file, a texture
+    whose image changes gets a new id.
+*/
+namespace DrawStream
+{
+    constexpr uint32_t fileMagic = 0x53444B4C; // "LKDS"
+    constexpr uint32_t frameMagic = 0x46444B4C; // "LKDF"
+    constexpr uint32_t version = 2;
+
+    constexpr uint32_t fileHeaderSize = 8;
+    constexpr uint32_t frameHeaderSize = 24;
+    constexpr uint32_t drawSize = 44;
+
+    enum class TextureKind : uint8_t
+    {
+        // Loaded back through TextureManager, with the scale of the definition
+        Path = 0,
+        // Textures without a path (baked chunks, generated images) are embedded
+        Image = 1,
+    };
+
+    struct FrameHeader
+    {
+        uint32_t magic;
+        uint32_t tick;
+        float zoom;
+        float aspect;
+        uint32_t definitionCount;
+        uint32_t drawCount;
+    };
+}
+
+#endif //DRAWSTREAM_H
@@ -0,0 +1,146 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "DrawStreamReader.h"
+
+#include <bit>
+#include <cassert>
+#include <string>
+#include <QtEndian>
+
+#include "DrawStream.h"
+#include "TransformKernel.h"
+#include "../Managers/TextureManager.h"
+#include "../Type/Errors.h"
+
+DrawStreamReader::DrawStreamReader(QIODevice* device): device(device)
+{
+    assert(device && device->isReadable());
+    if (readUInt() != DrawStream::fileMagic)
+    {
+        throw StreamFormatException("DrawStreamReader: not a draw capture");
+    }
+    if (readUInt() != DrawStream::version)
+    {
+        throw StreamFormatException("DrawStreamReader: unsupported version");
+    }
+}
+
+void DrawStreamReader::readExactly(char* data, const qint64 size)
+{
+    qint64 done = 0;
+    while (done < size)
+    {
+        const qint64 read = device->read(data + done, size - done);
+        if (read <= 0)
+        {
+            throw StreamFormatException("DrawStreamReader: truncated stream");
+        }
+        done += read;
+    }
+}
+
+uint32_t DrawStreamReader::readUInt()
+{
+    uint32_t value;
+    readExactly(reinterpret_cast<char*>(&value), sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+float DrawStreamReader::readFloat()
+{
+    return std::bit_cast<float>(readUInt());
+}
+
+bool DrawStreamReader::readFrame(Frame& frame)
+{
+    if (device->atEnd())
+    {
+        return false;
+    }
+    if (readUInt() != DrawStream::frameMagic)
+    {
+        throw StreamFormatException("DrawStreamReader: bad frame magic");
+    }
+    frame.tick = readUInt();
+    frame.zoom = readFloat();
+    frame.aspect = readFloat();
+    const uint32_t definitionCount = readUInt();
+    const uint32_t drawCount = readUInt();
+    for (uint32_t i = 0; i < definitionCount; i++)
+    {
+        readDefinition();
+    }
+
+    frame.textures.resize(drawCount);
+    frame.colors.resize(drawCount);
+    frame.matrices.assign(static_cast<size_t>(drawCount) * TransformKernel::matrixSize, 0.0f);
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+        const auto it = textures.find(readUInt());
+        if (it == textures.end())
+        {
+            throw StreamFormatException("DrawStreamReader: draw of an undefined texture");
+        }
+        frame.textures[i] = it->second;
+        float* matrix = frame.matrices.data() + i * TransformKernel::matrixSize;
+        matrix[0] = readFloat();
+        matrix[1] = readFloat();
+        matrix[3] = readFloat();
+        matrix[4] = readFloat();
+        matrix[5] = readFloat();
+        matrix[7] = readFloat();
+        matrix[10] = 1;
+        matrix[11] = readFloat();
+        matrix[15] = 1;
+        frame.colors[i].multiply = readUInt();
+        frame.colors[i].tint = readUInt();
+        frame.colors[i].flash = static_cast<uint8_t>(readUInt());
+    }
+    return true;
+}
+
+void DrawStreamReader::readDefinition()
+{
+    const uint32_t id = readUInt();
+    const float scale = readFloat();
+    char kind;
+    readExactly(&kind, 1);
+    QByteArray payload(readUInt(), Qt::Uninitialized);
+    readExactly(payload.data(), payload.size());
+
+    Texture* texture = nullptr;
+    if (static_cast<DrawStream::TextureKind>(kind) == DrawStream::TextureKind::Path)
+    {
+        TextureHandle handle = TextureManager::getInstance().getTexture(payload.toStdString(), {.scale = scale});
+        texture = handle.get();
+        if (texture)
+        {
+            loaded.push_back(std::move(handle));
+        }
+    }
+    else if (static_cast<DrawStream::TextureKind>(kind) == DrawStream::TextureKind::Image)
+    {
+        QImage image = QImage::fromData(payload, "PNG");
+        if (!image.isNull())
+        {
+            embedded.push_back(std::make_unique<Texture>(Texture{.image = std::move(image), .config = {.scale = scale}}));
+            texture = embedded.back().get();
+        }
+    }
+    else
+    {
+        throw StreamFormatException("DrawStreamReader: unknown texture kind");
+    }
+    if (!texture)
+    {
+        throw StreamFormatException("DrawStreamReader: cannot load texture " + std::to_string(id));
+    }
+    textures[id] = texture;
+}
+
+void DrawStreamReader::replay(RenderBackend& backend, const Frame& frame)
+{
+    drawSprites(backend, frame.textures.data(), frame.matrices.data(), frame.colors.data(), frame.size());
+}
@@ -0,0 +1,63 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef DRAWSTREAMREADER_H
+#define DRAWSTREAMREADER_H
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <QIODevice>
+
+#include "RenderBackend.h"
+#include "Texture.h"
+#include "../Managers/TextureHandle.h"
+
+/*
+    Reads the frames written by DrawCapture. Path textures are loaded through TextureManager, embedded ones
+    are decoded and owned by the reader, so frames stay valid as long as the reader lives.
+    Malformed input throws StreamFormatException.
+*/
+class DrawStreamReader
+{
+public:
+    struct Frame
+    {
+        uint32_t tick = 0;
+        float zoom = 0;
+        float aspect = 0;
+        // One entry per draw, matrices hold TransformKernel::matrixSize floats per draw
+        std::vector<Texture*> textures;
+        std::vector<float> matrices;
+        std::vector<SpriteColor> colors;
+
+        size_t size() const
+        {
+            return textures.size();
+        }
+    };
+
+    explicit DrawStreamReader(QIODevice* device);
+
+    // Reads the next frame, returns false at the end of the stream
+    bool readFrame(Frame& frame);
+
+    // Submits a frame exactly as it was captured
+    static void replay(RenderBackend& backend, const Frame& frame);
+
+private:
+    QIODevice* device;
+    std::unordered_map<uint32_t, Texture*> textures;
+    std::vector<std::unique_ptr<Texture>> embedded;
+    // Keeps the path textures resident while frames point at them
+    std::vector<TextureHandle> loaded;
+
+    void readExactly(char* data, qint64 size);
+    uint32_t readUInt();
+    float readFloat();
+    void readDefinition();
+};
+
+
+#endif //DRAWSTREAMREADER_H
@@ -0,0 +1,157 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "HudLayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QPainter>
+
+#include "TransformKernel.h"
+#include "../Managers/TextureManager.h"
+
+namespace
+{
+    constexpr float maxHealth = 100;
+    // Never produced by valueOf, forces a repaint after a new layout
+    constexpr int64_t unpainted = std::numeric_limits<int64_t>::max();
+    // Every widget is blank while the HUD is hidden
+    constexpr int64_t hidden = std::numeric_limits<int64_t>::min();
+}
+
+HudLayer::HudLayer()
+{
+    auto& textures = TextureManager::getInstance();
+    std::vector<TextureHandle> icons = textures.getAllTextures("assets/图标/UI/buff", {.scale = 1});
+    if (icons.size() > maxBuffs)
+    {
+        icons.resize(maxBuffs);
+    }
+    for (const auto& icon : icons)
+    {
+        // Before the simulation thread runs, so the pixels may still be expanded from here. A file that failed to
+        // load keeps its place with a null image, bit i stays the i-th icon
+        const Texture* texture = icon ? icon.pixels() : nullptr;
+        buffIcons.push_back(texture ? Icon{texture->image.copy(), textures.getTrim(texture)} : Icon{});
+    }
+}
+
+void HudLayer::layout(const QSize size)
+{
+    // Sized for a 360 pixel high window, scaled by whole pixels so icons stay crisp
+    const int unit = std::max(1, size.height() / 360);
+    widgets.clear();
+    widgets.push_back(Widget{WidgetKind::HealthBar, 0, QRect(8 * unit, 8 * unit, 100 * unit, 8 * unit), unpainted});
+    for (int i = 0; i < static_cast<int>(buffIcons.size()); i++)
+    {
+        widgets.push_back(Widget{
+            WidgetKind::BuffIcon, i, QRect((8 + i * 18) * unit, 20 * unit, 16 * unit, 16 * unit), unpainted
+        });
+    }
+}
+
+int64_t HudLayer::valueOf(const Widget& widget, const HudState& state)
+{
+    if (!state.visible)
+    {
+        return hidden;
+    }
+    switch (widget.kind)
+    {
+    case WidgetKind::HealthBar:
+        return std::lround(std::clamp(state.health, 0.0f, maxHealth));
+    case WidgetKind::BuffIcon:
+        return state.buffs >> widget.index & 1;
+    }
+    return hidden;
+}
+
+void HudLayer::update(const HudState& state, const QSize size)
+{
+    repainted = 0;
+    // Drop the reference draw() handed to the texture, so painting does not detach a copy of the surface
+    texture.image = QImage();
+    if (size != surface.size())
+    {
+        if (size.isEmpty())
+        {
+            surface = QImage();
+            widgets.clear();
+            return;
+        }
+        surface = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        surface.fill(Qt::transparent);
+        layout(size);
+    }
+
+    QPainter painter;
+    for (auto& widget : widgets)
+    {
+        const int64_t value = valueOf(widget, state);
+        if (value == widget.value)
+        {
+            continue;
+        }
+        if (!painter.isActive())
+        {
+            painter.begin(&surface);
+            painter.setRenderHint(QPainter::Antialiasing, false);
+        }
+        painter.setClipRect(widget.rect);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(widget.rect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        if (value != hidden)
+        {
+            paint(painter, widget, state);
+        }
+        widget.value = value;
+        repainted++;
+    }
+    shown = state;
+}
+
+void HudLayer::paint(QPainter& painter, const Widget& widget, const HudState& state) const
+{
+    const QRect& rect = widget.rect;
+    switch (widget.kind)
+    {
+    case WidgetKind::HealthBar:
+        {
+            const float fraction = std::clamp(state.health / maxHealth, 0.0f, 1.0f);
+            painter.fillRect(rect, QColor(0, 0, 0, 160));
+            QRect bar = rect.adjusted(1, 1, -1, -1);
+            bar.setWidth(static_cast<int>(std::lround(static_cast<float>(bar.width()) * fraction)));
+            painter.fillRect(bar, QColor::fromHsvF(fraction / 3, 0.8f, 0.9f));
+            break;
+        }
+    case WidgetKind::BuffIcon:
+        if (state.buffs >> widget.index & 1)
+        {
+            const Icon& icon = buffIcons[widget.index];
+            // A trimmed icon only covers its opaque part of the rect
+            painter.drawImage(SpriteTrim::place(icon.trim, rect), icon.image);
+        }
+        break;
+    }
+}
+
+void HudLayer::draw(RenderBackend& backend, const float zoom)
+{
+    if (surface.isNull() || !shown.visible || zoom <= 0)
+    {
+        return;
+    }
+    // A sprite of 2 / zoom world units high at the camera centre covers the window, the surface has its aspect
+    texture.image = surface;
+    texture.config.scale = 2 / zoom;
+    float matrix[TransformKernel::matrixSize] = {
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, depth,
+        0, 0, 0, 1,
+    };
+    backend.draw(texture, matrix, SpriteColor{});
+}
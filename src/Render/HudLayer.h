@@ -0,0 +1,84 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef HUDLAYER_H
+#define HUDLAYER_H
+#include <cstdint>
+#include <vector>
+#include <QImage>
+#include <QRect>
+
+#include "HudState.h"
+#include "RenderBackend.h"
+#include "SpriteTrim.h"
+#include "Texture.h"
+
+class QPainter;
+
+/*
+    Retained HUD: the widgets (health bar, buff icons) are laid out once per window size and painted into an
+    offscreen surface that is kept between frames. update() only repaints the rectangles of the widgets whose bound
+    value changed, and draw() composites the whole surface as a single screen sized quad. GUI thread only.
+    Must be created before the simulation starts, it copies its icons out of TextureManager.
+*/
+class HudLayer
+{
+public:
+    constexpr static int maxBuffs = 8;
+    // In front of every world sprite
+    constexpr static float depth = 1000;
+
+    HudLayer();
+
+    // Brings the surface up to date with state for a window of the given size in pixels
+    void update(const HudState& state, QSize size);
+
+    // The camera looks at the origin and shows 2 / zoom world units vertically
+    void draw(RenderBackend& backend, float zoom);
+
+    // Widgets repainted by the last update(), for profiling
+    int repaintedWidgets() const
+    {
+        return repainted;
+    }
+
+private:
+    enum class WidgetKind : uint8_t
+    {
+        HealthBar,
+        BuffIcon,
+    };
+
+    struct Widget
+    {
+        WidgetKind kind;
+        // Buff index for BuffIcon
+        int index;
+        QRect rect;
+        // Bound value at the last paint
+        int64_t value;
+    };
+
+    struct Icon
+    {
+        // A copy of its own, the texture may be packed or evicted while the HUD shows it
+        QImage image;
+        SpriteTrim::Trim trim;
+    };
+
+    std::vector<Widget> widgets;
+    std::vector<Icon> buffIcons;
+    HudState shown;
+    // Painted in place, the texture shares the image only while it is being drawn
+    QImage surface;
+    Texture texture;
+    int repainted = 0;
+
+    void layout(QSize size);
+    static int64_t valueOf(const Widget& widget, const HudState& state);
+    void paint(QPainter& painter, const Widget& widget, const HudState& state) const;
+};
+
+
+#endif //HUDLAYER_H
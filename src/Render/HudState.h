@@ -0,0 +1,20 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef HUDSTATE_H
+#define HUDSTATE_H
+#include <cstdint>
+
+// The status values the HUD shows, copied out of the registry with every snapshot
+struct HudState {
+    // No player, the HUD is hidden
+    bool visible = false;
+    float health = 0;
+    // StatusBuff::active
+    uint32_t buffs = 0;
+
+    bool operator==(const HudState&) const = default;
+};
+
+#endif //HUDSTATE_H
@@ -0,0 +1,108 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIP_CHAIN_SSE2
+#endif
+
+namespace
+{
+    uint32_t average(const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t d)
+    {
+        uint32_t result = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            const uint32_t sum = (a >> shift & 0xFF) + (b >> shift & 0xFF) + (c >> shift & 0xFF) + (d >> shift & 0xFF);
+            result |= (sum + 2) >> 2 << shift;
+        }
+        return result;
+    }
+
+    // Output pixels [first, last) of a row, reading rows top and bottom of a source width pixels wide
+    void halveRowScalar(const uint32_t* top, const uint32_t* bottom, const int width, uint32_t* out, const int first,
+                        const int last)
+    {
+        for (int x = first; x < last; x++)
+        {
+            const int left = std::min(2 * x, width - 1);
+            const int right = std::min(2 * x + 1, width - 1);
+            out[x] = average(top[left], top[right], bottom[left], bottom[right]);
+        }
+    }
+
+    void halveRow(const uint32_t* top, const uint32_t* bottom, const int width, uint32_t* out, const int outWidth)
+    {
+        int x = 0;
+#ifdef MIP_CHAIN_SSE2
+        // 4 source pixels of each row make 2 output pixels, only where both columns of every box exist
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 2 <= width / 2; x += 2)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * x));
+            // Columns 0 and 1, then 2 and 3, each channel widened to 16 bits and summed over both rows
+            const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            const __m128i pairs = _mm_unpacklo_epi64(_mm_add_epi16(low, _mm_srli_si128(low, 8)),
+                                                     _mm_add_epi16(high, _mm_srli_si128(high, 8)));
+            const __m128i averaged = _mm_srli_epi16(_mm_add_epi16(pairs, rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(averaged, averaged));
+        }
+#endif
+        halveRowScalar(top, bottom, width, out, x, outWidth);
+    }
+}
+
+QImage MipChain::halve(const QImage& image)
+{
+    if (image.isNull())
+    {
+        return {};
+    }
+    const QImage source = image.format() == QImage::Format_ARGB32_Premultiplied
+                              ? image
+                              : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int width = source.width();
+    const int height = source.height();
+    const int outWidth = std::max(1, width / 2);
+    const int outHeight = std::max(1, height / 2);
+    QImage result(outWidth, outHeight, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < outHeight; y++)
+    {
+        const auto top = reinterpret_cast<const uint32_t*>(source.constScanLine(std::min(2 * y, height - 1)));
+        const auto bottom = reinterpret_cast<const uint32_t*>(source.constScanLine(std::min(2 * y + 1, height - 1)));
+        halveRow(top, bottom, width, reinterpret_cast<uint32_t*>(result.scanLine(y)), outWidth);
+    }
+    return result;
+}
+
+QImage MipChain::fitHeight(const QImage& image, const int maxHeight)
+{
+    QImage result = image;
+    // Never below maxHeight, like TextureHandle::level(): every screen pixel keeps a texel
+    while (maxHeight > 0 && result.height() / 2 >= maxHeight)
+    {
+        result = halve(result);
+    }
+    return result;
+}
+
+std::vector<QImage> MipChain::build(const QImage& image, const int minHeight)
+{
+    std::vector<QImage> levels;
+    const QImage* previous = &image;
+    while (previous->height() / 2 >= std::max(minHeight, 1))
+    {
+        levels.push_back(halve(*previous));
+        previous = &levels.back();
+    }
+    return levels;
+}
@@ -0,0 +1,29 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef MIPCHAIN_H
+#define MIPCHAIN_H
+#include <vector>
+#include <QImage>
+
+/*
+    Downsampling of premultiplied ARGB32 images for texture levels. Every level halves both dimensions (never below
+    1 pixel), each pixel the rounded average of a 2x2 box of the level above; averaging premultiplied pixels keeps
+    transparent texels from bleeding their colour into the edges of a sprite. SSE2 handles 2 output pixels per step
+    on x86-64, a scalar loop does the rest.
+*/
+namespace MipChain
+{
+    // Converted to premultiplied ARGB32 first if needed
+    QImage halve(const QImage& image);
+
+    // Halved while the result is still at least maxHeight pixels high, so it stays between maxHeight and twice that.
+    // Untouched when already small enough or maxHeight <= 0
+    QImage fitHeight(const QImage& image, int maxHeight);
+
+    // Levels below the image, largest first, down to the last one still minHeight pixels high
+    std::vector<QImage> build(const QImage& image, int minHeight);
+}
+
+#endif //MIPCHAIN_H
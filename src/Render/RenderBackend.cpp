@@ -0,0 +1,40 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "RenderBackend.h"
+
+#include "TransformKernel.h"
+
+void RenderBackend::drawRun(Texture& texture, const float* matrices, const SpriteColor* colors, const size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        draw(texture, matrices + i * TransformKernel::matrixSize, colors[i]);
+    }
+}
+
+void drawSprites(RenderBackend& backend, Texture* const* textures, const float* matrices, const SpriteColor* colors,
+                 const size_t count)
+{
+    for (size_t first = 0; first < count;)
+    {
+        Texture& texture = *textures[first];
+        size_t last = first + 1;
+        while (last < count && textures[last] == &texture)
+        {
+            last++;
+        }
+        backend.drawRun(texture, matrices + first * TransformKernel::matrixSize, colors + first, last - first);
+        first = last;
+    }
+}
+
+void drawSnapshot(RenderBackend& backend, const RenderSnapshot& snapshot, std::vector<float>& matrices)
+{
+    // Convert all transforms in one vectorised pass, then submit
+    matrices.resize(snapshot.transforms.size() * TransformKernel::matrixSize);
+    TransformKernel::toMatrices(snapshot.transforms.data(), snapshot.transforms.size(), matrices.data());
+    // The render queue keeps sprites of one texture together within a depth
+    drawSprites(backend, snapshot.textures.data(), matrices.data(), snapshot.colors.data(), snapshot.textures.size());
+}
@@ -0,0 +1,37 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+#include <cstddef>
+#include <vector>
+
+#include "RenderSnapshot.h"
+#include "Texture.h"
+#include "../Type/SpriteColor.h"
+
+/*
+    Where the sprites of a snapshot end up. Scene draws through SpiritBatchBackend (QRenderer2D, OpenGL),
+    SoftwareRenderer rasterises the very same stream into a QImage for GPU-less benchmarks and pixel tests.
+    Matrices are 16 row-major floats each, as written by TransformKernel, every sprite has its SpriteColor.
+*/
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void draw(Texture& texture, const float* matrix, const SpriteColor& color) = 0;
+
+    // count sprites sharing one texture, matrices back to back
+    virtual void drawRun(Texture& texture, const float* matrices, const SpriteColor* colors, size_t count);
+};
+
+// Draws count sprites in order, each run of consecutive sprites sharing a texture in a single drawRun
+void drawSprites(RenderBackend& backend, Texture* const* textures, const float* matrices, const SpriteColor* colors,
+                 size_t count);
+
+// Converts the snapshot transforms (matrices is scratch space kept by the caller) and draws them with drawSprites
+void drawSnapshot(RenderBackend& backend, const RenderSnapshot& snapshot, std::vector<float>& matrices);
+
+#endif //RENDERBACKEND_H
@@ -0,0 +1,177 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#include "../Components/Drawable.h"
+#include "../Components/Transform.h"
+
+RenderQueue::RenderQueue(entt::registry& registry) : registry(registry)
+{
+    registry.on_construct<Drawable>().connect<&RenderQueue::onChanged>(this);
+    registry.on_update<Drawable>().connect<&RenderQueue::onChanged>(this);
+    registry.on_destroy<Drawable>().connect<&RenderQueue::onChanged>(this);
+    registry.on_construct<Transform>().connect<&RenderQueue::onChanged>(this);
+    registry.on_update<Transform>().connect<&RenderQueue::onChanged>(this);
+    registry.on_destroy<Transform>().connect<&RenderQueue::onChanged>(this);
+
+    for (const auto entity : registry.view<const Drawable, const Transform>())
+    {
+        onChanged(registry, entity);
+    }
+}
+
+RenderQueue::~RenderQueue()
+{
+    registry.on_construct<Drawable>().disconnect(this);
+    registry.on_update<Drawable>().disconnect(this);
+    registry.on_destroy<Drawable>().disconnect(this);
+    registry.on_construct<Transform>().disconnect(this);
+    registry.on_update<Transform>().disconnect(this);
+    registry.on_destroy<Transform>().disconnect(this);
+}
+
+uint64_t RenderQueue::makeKey(const uint8_t layer, const float z, const uint32_t textureId)
+{
+    // Flip the sign bit of positive floats and every bit of negative ones so the integers sort like the floats
+    auto depth = std::bit_cast<uint32_t>(z);
+    depth ^= depth & 0x80000000u ? 0xFFFFFFFFu : 0x80000000u;
+    return static_cast<uint64_t>(layer) << 56 | static_cast<uint64_t>(depth) << 24 | (textureId & textureIdMask);
+}
+
+void RenderQueue::onChanged(entt::registry&, const entt::entity entity)
+{
+    const auto index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= changedSlots.size())
+    {
+        changedSlots.resize(index + 1, 0);
+    }
+    if (changedSlots[index])
+    {
+        // A recycled index replaces the entity it belonged to
+        changed[changedSlots[index] - 1] = entity;
+        return;
+    }
+    changed.push_back(entity);
+    changedSlots[index] = static_cast<uint32_t>(changed.size());
+}
+
+void RenderQueue::update()
+{
+    if (changed.empty())
+    {
+        return;
+    }
+
+    // Drop the stale entries of every changed index and key the ones that are still drawable.
+    // Destroy signals fire before the component is gone, hence the extra check on the storages
+    fresh.clear();
+    size_t removed = 0;
+    auto& drawables = registry.storage<Drawable>();
+    auto& transforms = registry.storage<Transform>();
+    for (const auto entity : changed)
+    {
+        const auto index = static_cast<size_t>(entt::to_entity(entity));
+        changedSlots[index] = 0;
+        if (index < positions.size() && positions[index] != npos)
+        {
+            entries[positions[index]].entity = entt::null;
+            positions[index] = npos;
+            removed++;
+        }
+        if (registry.valid(entity) && drawables.contains(entity) && transforms.contains(entity))
+        {
+            const auto& drawable = drawables.get(entity);
+            const auto& transform = transforms.get(entity);
+            fresh.push_back({makeKey(drawable.layer, transform.z, drawable.texture.id()), entity});
+        }
+    }
+    changed.clear();
+
+    if (removed)
+    {
+        std::erase_if(entries, [](const Entry& entry) { return entry.entity == entt::null; });
+    }
+
+    if (fresh.size() * 8 < entries.size())
+    {
+        // Few changes: sort them on their own and merge into the sorted list
+        std::sort(fresh.begin(), fresh.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; });
+        scratch.resize(entries.size() + fresh.size());
+        std::merge(entries.begin(), entries.end(), fresh.begin(), fresh.end(), scratch.begin(),
+                   [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; });
+        entries.swap(scratch);
+    }
+    else
+    {
+        entries.insert(entries.end(), fresh.begin(), fresh.end());
+        radixSort(entries, scratch);
+    }
+    rebuildPositions();
+}
+
+void RenderQueue::rebuildPositions()
+{
+    for (uint32_t position = 0; position < entries.size(); position++)
+    {
+        const auto index = static_cast<size_t>(entt::to_entity(entries[position].entity));
+        if (index >= positions.size())
+        {
+            positions.resize(index + 1, npos);
+        }
+        positions[index] = position;
+    }
+}
+
+void RenderQueue::radixSort(std::vector<Entry>& values, std::vector<Entry>& buffer)
+{
+    // LSD over the 8 bytes of the key, stable so equal keys keep their previous order
+    buffer.resize(values.size());
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t counts[256] = {};
+        for (const auto& value : values)
+        {
+            counts[value.key >> shift & 0xFF]++;
+        }
+        // Every key shares this byte (layer and texture id bits usually do), nothing to move
+        if (counts[values.empty() ? 0 : values.front().key >> shift & 0xFF] == values.size())
+        {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto& count : counts)
+        {
+            const size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (const auto& value : values)
+        {
+            buffer[counts[value.key >> shift & 0xFF]++] = value;
+        }
+        values.swap(buffer);
+    }
+}
+
+void RenderQueue::order(std::vector<entt::entity>& entities)
+{
+    order32.clear();
+    order32.reserve(entities.size());
+    for (const auto entity : entities)
+    {
+        const auto index = static_cast<size_t>(entt::to_entity(entity));
+        assert(index < positions.size() && positions[index] != npos);
+        order32.push_back(positions[index]);
+    }
+    std::sort(order32.begin(), order32.end());
+    for (size_t i = 0; i < order32.size(); i++)
+    {
+        entities[i] = entries[order32[i]].entity;
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+#include <cstdint>
+#include <vector>
+
+#include "entt/entity/registry.hpp"
+
+/*
+    Draw order of every entity with a Drawable and a Transform, kept sorted by a 64 bit key:
+        layer (8 bits) | z (32 bits, order preserving) | texture id (24 bits, TextureHandle::id())
+    so layers and depth are respected by construction and sprites sharing a texture end up next to each other.
+    The queue listens to the registry and only re-keys the entities that changed since the last update(),
+    merging them back into the sorted list; a full radix sort is only done when a large part of it changed.
+*/
+class RenderQueue
+{
+public:
+    explicit RenderQueue(entt::registry& registry);
+    ~RenderQueue();
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // Applies the changes recorded since the last call
+    void update();
+
+    // Rearranges entities, all tracked by the queue, into draw order
+    void order(std::vector<entt::entity>& entities);
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    static uint64_t makeKey(uint8_t layer, float z, uint32_t textureId);
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        entt::entity entity;
+    };
+
+    constexpr static uint32_t npos = UINT32_MAX;
+    constexpr static uint32_t textureIdMask = (1u << 24) - 1;
+
+    entt::registry& registry;
+    // Sorted by key
+    std::vector<Entry> entries;
+    // Position in entries per entity index, npos when not queued
+    std::vector<uint32_t> positions;
+    // Entities to re-key, changedSlots maps an entity index to its slot + 1 in changed
+    std::vector<entt::entity> changed;
+    std::vector<uint32_t> changedSlots;
+
+    std::vector<Entry> fresh;
+    std::vector<Entry> scratch;
+    std::vector<uint32_t> order32;
+
+    void onChanged(entt::registry& registry, entt::entity entity);
+    void rebuildPositions();
+    static void radixSort(std::vector<Entry>& values, std::vector<Entry>& buffer);
+};
+
+
+#endif //RENDERQUEUE_H
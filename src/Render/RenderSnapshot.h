@@ -0,0 +1,37 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "HudState.h"
+#include "Texture.h"
+#include "../Components/Transform.h"
+#include "../Type/SpriteColor.h"
+
+// Everything the renderer needs from one simulation tick: the visible sprites, culled and in draw order.
+// Built by the simulation thread, read by the GUI thread, never touches the registry.
+struct RenderSnapshot {
+    uint32_t tick = 0;
+    // One entry per sprite, kept as parallel arrays so the transforms feed TransformKernel directly
+    std::vector<Texture *> textures;
+    std::vector<Transform> transforms;
+    std::vector<SpriteColor> colors;
+    // Textures owned by the simulation that may be replaced while this snapshot is on screen (baked chunks)
+    std::vector<std::shared_ptr<Texture>> retained;
+    HudState hud;
+
+    void clear() {
+        textures.clear();
+        transforms.clear();
+        colors.clear();
+        retained.clear();
+        hud = {};
+    }
+};
+
+#endif //RENDERSNAPSHOT_H
@@ -0,0 +1,334 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_SSE2
+#endif
+
+namespace
+{
+    // Premultiplied source over destination, x / 255 computed as (t + (t >> 8)) >> 8 with t = x + 128,
+    // which is exact for the products of two bytes. The SSE2 path below uses the same arithmetic
+    inline uint32_t blendPixel(const uint32_t src, const uint32_t dst)
+    {
+        const uint32_t inverse = 255 - (src >> 24);
+        uint32_t rb = (dst & 0x00FF00FF) * inverse + 0x00800080;
+        uint32_t ag = (dst >> 8 & 0x00FF00FF) * inverse + 0x00800080;
+        rb = (rb + (rb >> 8 & 0x00FF00FF)) >> 8 & 0x00FF00FF;
+        ag = (ag + (ag >> 8 & 0x00FF00FF)) & 0xFF00FF00;
+        return src + (rb | ag);
+    }
+
+    inline uint32_t divide255(const uint32_t value)
+    {
+        const uint32_t t = value + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    // SpriteColor applied to a premultiplied texel
+    inline uint32_t modulate(const uint32_t texel, const SpriteColor& color)
+    {
+        const uint32_t alpha = texel >> 24;
+        const uint32_t tintAmount = color.tint >> 24;
+        const uint32_t multiplyAlpha = color.multiply >> 24;
+        uint32_t result = divide255(alpha * multiplyAlpha) << 24;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            int32_t channel = static_cast<int32_t>(texel >> shift & 0xFF);
+            // Tint and white are premultiplied by the texel alpha so the result stays premultiplied
+            const auto tinted = static_cast<int32_t>(divide255((color.tint >> shift & 0xFF) * alpha));
+            channel += (tinted - channel) * static_cast<int32_t>(tintAmount) / 255;
+            channel += (static_cast<int32_t>(alpha) - channel) * color.flash / 255;
+            const uint32_t factor = divide255((color.multiply >> shift & 0xFF) * multiplyAlpha);
+            result |= divide255(static_cast<uint32_t>(channel) * factor) << shift;
+        }
+        return result;
+    }
+
+#if defined(SOFTWARE_RENDERER_SSE2)
+    inline __m128i blendPixels(const __m128i src, const __m128i dst)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(255);
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i srcLow = _mm_unpacklo_epi8(src, zero);
+        const __m128i srcHigh = _mm_unpackhi_epi8(src, zero);
+        // Alpha of each pixel broadcast to its four channels
+        const __m128i alphaLow = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLow, _MM_SHUFFLE(3, 3, 3, 3)),
+                                                     _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i alphaHigh = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHigh, _MM_SHUFFLE(3, 3, 3, 3)),
+                                                      _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, alphaLow));
+        __m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, alphaHigh));
+        low = _mm_add_epi16(low, half);
+        high = _mm_add_epi16(high, half);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        return _mm_adds_epu8(src, _mm_packus_epi16(low, high));
+    }
+#endif
+
+    // Blends count texels into dst, texel i is at (u + du * i, v + dv * i) clamped into the image
+    template <bool Colored>
+    void fillSpan(uint32_t* dst, const int count, const float u, const float du, const float v, const float dv,
+                  const uint32_t* texels, const qsizetype stride, const float maxU, const float maxV,
+                  const SpriteColor& color)
+    {
+        const auto fetch = [&](const int tu, const int tv)
+        {
+            const uint32_t texel = texels[tv * stride + tu];
+            return Colored ? modulate(texel, color) : texel;
+        };
+        int i = 0;
+#if defined(SOFTWARE_RENDERER_SSE2)
+        const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 limitU = _mm_set1_ps(maxU);
+        const __m128 limitV = _mm_set1_ps(maxV);
+        const __m128 stepU = _mm_set1_ps(du);
+        const __m128 stepV = _mm_set1_ps(dv);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+            __m128 us = _mm_add_ps(_mm_set1_ps(u), _mm_mul_ps(index, stepU));
+            __m128 vs = _mm_add_ps(_mm_set1_ps(v), _mm_mul_ps(index, stepV));
+            us = _mm_min_ps(_mm_max_ps(us, zero), limitU);
+            vs = _mm_min_ps(_mm_max_ps(vs, zero), limitV);
+            alignas(16) int32_t tu[4];
+            alignas(16) int32_t tv[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(tu), _mm_cvttps_epi32(us));
+            _mm_store_si128(reinterpret_cast<__m128i*>(tv), _mm_cvttps_epi32(vs));
+            // No gather before AVX2, fetch the four texels one by one
+            const __m128i src = _mm_setr_epi32(static_cast<int>(fetch(tu[0], tv[0])),
+                                               static_cast<int>(fetch(tu[1], tv[1])),
+                                               static_cast<int>(fetch(tu[2], tv[2])),
+                                               static_cast<int>(fetch(tu[3], tv[3])));
+            auto* out = reinterpret_cast<__m128i*>(dst + i);
+            _mm_storeu_si128(out, blendPixels(src, _mm_loadu_si128(out)));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            const float fi = static_cast<float>(i);
+            const auto tu = static_cast<int>(std::min(std::max(u + fi * du, 0.0f), maxU));
+            const auto tv = static_cast<int>(std::min(std::max(v + fi * dv, 0.0f), maxV));
+            dst[i] = blendPixel(fetch(tu, tv), dst[i]);
+        }
+    }
+
+    // Narrows [low, high) to the pixels x whose centre maps inside [0, size) along one texel axis
+    inline void clipAxis(const float a, const float k, const float size, float& low, float& high)
+    {
+        if (a == 0)
+        {
+            if (k < 0 || k >= size)
+            {
+                high = low;
+            }
+            return;
+        }
+        float t0 = -k / a - 0.5f;
+        float t1 = (size - k) / a - 0.5f;
+        if (a < 0)
+        {
+            std::swap(t0, t1);
+        }
+        low = std::max(low, t0);
+        high = std::min(high, t1);
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(const int width, const int height, const float zoom, const int threadCount)
+    : target(width, height, QImage::Format_ARGB32_Premultiplied), zoom(zoom),
+      tilesX((width + tileSize - 1) / tileSize), tilesY((height + tileSize - 1) / tileSize),
+      bins(static_cast<size_t>(tilesX) * tilesY)
+{
+    scheduler = enkiNewTaskScheduler();
+    struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig(scheduler);
+    config.numTaskThreadsToCreate = std::max(threadCount, 1) - 1;
+    enkiInitTaskSchedulerWithConfig(scheduler, config);
+    tileTask = enkiCreateTaskSet(scheduler, &SoftwareRenderer::rasteriseTiles);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+    enkiDeleteTaskSet(scheduler, tileTask);
+    enkiDeleteTaskScheduler(scheduler);
+}
+
+void SoftwareRenderer::begin(const uint32_t clearColor)
+{
+    target.fill(clearColor);
+    quads.clear();
+}
+
+const QImage* SoftwareRenderer::sourceOf(const Texture& texture)
+{
+    if (texture.image.format() == QImage::Format_ARGB32_Premultiplied)
+    {
+        return &texture.image;
+    }
+    auto& [key, copy] = converted[&texture];
+    if (copy.isNull() || key != texture.image.cacheKey())
+    {
+        key = texture.image.cacheKey();
+        copy = texture.image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    return &copy;
+}
+
+void SoftwareRenderer::draw(Texture& texture, const float* matrix, const SpriteColor& color)
+{
+    if (texture.image.isNull() || texture.config.scale <= 0)
+    {
+        return;
+    }
+    const QImage* source = sourceOf(texture);
+    const auto imageWidth = static_cast<float>(source->width());
+    const auto imageHeight = static_cast<float>(source->height());
+    const float height = texture.config.scale;
+    const float width = height * imageWidth / imageHeight;
+
+    // texel -> sprite local: x = u * su + tu, y = v * sv + tv (image rows grow downwards)
+    const float su = width / imageWidth;
+    const float tu = -width / 2;
+    const float sv = -height / imageHeight;
+    const float tv = height / 2;
+    // world -> pixel: px = W / 2 + k * x, py = H / 2 - k * y
+    const float k = zoom * static_cast<float>(target.height()) / 2;
+    const float f00 = k * matrix[0] * su;
+    const float f01 = k * matrix[1] * sv;
+    const float f10 = -k * matrix[4] * su;
+    const float f11 = -k * matrix[5] * sv;
+    const float gx = k * (matrix[0] * tu + matrix[1] * tv + matrix[3]) + static_cast<float>(target.width()) / 2;
+    const float gy = -k * (matrix[4] * tu + matrix[5] * tv + matrix[7]) + static_cast<float>(target.height()) / 2;
+    const float determinant = f00 * f11 - f01 * f10;
+    if (std::abs(determinant) < 1e-12f)
+    {
+        return;
+    }
+
+    float minX = gx;
+    float maxX = gx;
+    float minY = gy;
+    float maxY = gy;
+    for (const auto [cu, cv] : {std::pair{imageWidth, 0.0f}, {0.0f, imageHeight}, {imageWidth, imageHeight}})
+    {
+        const float x = f00 * cu + f01 * cv + gx;
+        const float y = f10 * cu + f11 * cv + gy;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+    Quad quad{
+        .source = source,
+        .color = color,
+        .minX = std::max(0, static_cast<int>(std::floor(minX))),
+        .minY = std::max(0, static_cast<int>(std::floor(minY))),
+        .maxX = std::min(target.width(), static_cast<int>(std::ceil(maxX))),
+        .maxY = std::min(target.height(), static_cast<int>(std::ceil(maxY))),
+    };
+    if (quad.minX >= quad.maxX || quad.minY >= quad.maxY)
+    {
+        return;
+    }
+    const float inverse = 1 / determinant;
+    quad.ux = f11 * inverse;
+    quad.uy = -f01 * inverse;
+    quad.u0 = -(quad.ux * gx + quad.uy * gy);
+    quad.vx = -f10 * inverse;
+    quad.vy = f00 * inverse;
+    quad.v0 = -(quad.vx * gx + quad.vy * gy);
+    quads.push_back(quad);
+}
+
+void SoftwareRenderer::end()
+{
+    for (auto& bin : bins)
+    {
+        bin.clear();
+    }
+    for (uint32_t index = 0; index < quads.size(); index++)
+    {
+        const Quad& quad = quads[index];
+        for (int ty = quad.minY / tileSize; ty <= (quad.maxY - 1) / tileSize; ty++)
+        {
+            for (int tx = quad.minX / tileSize; tx <= (quad.maxX - 1) / tileSize; tx++)
+            {
+                bins[ty * tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    // Detach once here, the tiles then write disjoint parts of the same buffer
+    pixels = reinterpret_cast<uint32_t*>(target.bits());
+    enkiParamsTaskSet params{};
+    params.setSize = static_cast<uint32_t>(bins.size());
+    params.minRange = 1;
+    params.pArgs = this;
+    params.priority = 0;
+    enkiSetParamsTaskSet(tileTask, params);
+    enkiAddTaskSet(scheduler, tileTask);
+    enkiWaitForTaskSet(scheduler, tileTask);
+}
+
+void SoftwareRenderer::rasteriseTiles(const uint32_t start, const uint32_t end, uint32_t, void* context)
+{
+    const auto renderer = static_cast<SoftwareRenderer*>(context);
+    for (uint32_t tile = start; tile < end; tile++)
+    {
+        renderer->rasteriseTile(static_cast<int>(tile));
+    }
+}
+
+void SoftwareRenderer::rasteriseTile(const int tile)
+{
+    const int tileX0 = tile % tilesX * tileSize;
+    const int tileY0 = tile / tilesX * tileSize;
+    const int tileX1 = std::min(tileX0 + tileSize, target.width());
+    const int tileY1 = std::min(tileY0 + tileSize, target.height());
+    const qsizetype pixelStride = target.bytesPerLine() / 4;
+
+    for (const uint32_t index : bins[tile])
+    {
+        const Quad& quad = quads[index];
+        const auto texels = reinterpret_cast<const uint32_t*>(quad.source->constBits());
+        const qsizetype texelStride = quad.source->bytesPerLine() / 4;
+        const auto sourceWidth = static_cast<float>(quad.source->width());
+        const auto sourceHeight = static_cast<float>(quad.source->height());
+        const int x0 = std::max(quad.minX, tileX0);
+        const int x1 = std::min(quad.maxX, tileX1);
+        const int y0 = std::max(quad.minY, tileY0);
+        const int y1 = std::min(quad.maxY, tileY1);
+        for (int y = y0; y < y1; y++)
+        {
+            const float centreY = static_cast<float>(y) + 0.5f;
+            const float ku = quad.uy * centreY + quad.u0;
+            const float kv = quad.vy * centreY + quad.v0;
+            // The quad is convex, its pixels on a row form one span
+            float low = static_cast<float>(x0);
+            float high = static_cast<float>(x1);
+            clipAxis(quad.ux, ku, sourceWidth, low, high);
+            clipAxis(quad.vx, kv, sourceHeight, low, high);
+            const int start = std::max(x0, static_cast<int>(std::ceil(low)));
+            const int stop = std::min(x1, static_cast<int>(std::ceil(high)));
+            if (start >= stop)
+            {
+                continue;
+            }
+            const float centreX = static_cast<float>(start) + 0.5f;
+            const auto fill = quad.color.isPlain() ? fillSpan<false> : fillSpan<true>;
+            fill(pixels + y * pixelStride + start, stop - start,
+                 quad.ux * centreX + ku, quad.ux, quad.vx * centreX + kv, quad.vx,
+                 texels, texelStride, sourceWidth - 1, sourceHeight - 1, quad.color);
+        }
+    }
+}
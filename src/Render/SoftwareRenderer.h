@@ -0,0 +1,90 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <QImage>
+
+#include "RenderBackend.h"
+#include "TaskScheduler_c.h"
+
+/*
+    CPU rasteriser behind the RenderBackend interface, for machines without a GPU (CI, servers).
+    draw() only records quads, end() rasterises them into a premultiplied ARGB32 image: the target is split
+    into tiles rendered in parallel on an enkiTS scheduler, each tile walks its quads in submission order and
+    fills spans with SSE2 source-over blending (nearest texel sampling), modulating texels by the SpriteColor.
+    The camera matches Scene: centred on the origin, zoom maps world units to clip space vertically, and a
+    sprite is a quad of config.scale world units high with the aspect of its image.
+*/
+class SoftwareRenderer final : public RenderBackend
+{
+public:
+    constexpr static int tileSize = 64;
+
+    SoftwareRenderer(int width, int height, float zoom, int threadCount = 4);
+    ~SoftwareRenderer() override;
+
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    // Starts a frame cleared to clearColor (premultiplied 0xAARRGGBB)
+    void begin(uint32_t clearColor = 0xFF000000);
+    void draw(Texture& texture, const float* matrix, const SpriteColor& color) override;
+    // Rasterises everything drawn since begin()
+    void end();
+
+    // Camera zoom used by the following draws
+    void setZoom(float zoom)
+    {
+        this->zoom = zoom;
+    }
+
+    const QImage& image() const
+    {
+        return target;
+    }
+
+    size_t quadCount() const
+    {
+        return quads.size();
+    }
+
+private:
+    struct Quad
+    {
+        const QImage* source;
+        SpriteColor color;
+        // Texel coordinates of a pixel centre: u = ux * x + uy * y + u0, likewise v
+        float ux, uy, u0;
+        float vx, vy, v0;
+        // Pixel bounds, clipped to the target, max exclusive
+        int minX, minY, maxX, maxY;
+    };
+
+    QImage target;
+    // target.bits() taken once per frame, before the tiles run
+    uint32_t* pixels = nullptr;
+    float zoom;
+    int tilesX;
+    int tilesY;
+    std::vector<Quad> quads;
+    // Quads overlapping each tile, in submission order
+    std::vector<std::vector<uint32_t>> bins;
+    // Premultiplied copies of textures stored in another format, keyed by the cacheKey of the original
+    std::unordered_map<const Texture*, std::pair<qint64, QImage>> converted;
+
+    enkiTaskScheduler* scheduler;
+    enkiTaskSet* tileTask;
+
+    const QImage* sourceOf(const Texture& texture);
+    void rasteriseTile(int tile);
+    static void rasteriseTiles(uint32_t start, uint32_t end, uint32_t threadIndex, void* context);
+};
+
+
+#endif //SOFTWARERENDERER_H
@@ -0,0 +1,51 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SPIRITBATCHBACKEND_H
+#define SPIRITBATCHBACKEND_H
+#include <QMatrix4x4>
+#include <QVector4D>
+
+#include "RenderBackend.h"
+#include "SpiritBatch.h"
+
+static_assert(requires(SpiritBatch& batch, Texture& texture, const QMatrix4x4& matrix, const QVector4D& rgba)
+              {
+                  batch.draw(texture, matrix, rgba, 0.0f, rgba);
+              }, "SpiritBatchBackend needs SpiritBatch::draw(Texture&, const QMatrix4x4&, tint, flash, multiply)");
+
+/*
+    Forwards to the QRenderer2D batch of the current frame. SpiritBatch takes the SpriteColor of every sprite
+    along with it and sets the tint, flash and multiply uniforms of t_fshader.glsl for that sprite alone, plain
+    sprites included so nothing carries over from the previous one.
+*/
+class SpiritBatchBackend final : public RenderBackend
+{
+public:
+    explicit SpiritBatchBackend(SpiritBatch& batch) : batch(batch)
+    {
+    }
+
+    void draw(Texture& texture, const float* matrix, const SpriteColor& color) override
+    {
+        batch.draw(texture, QMatrix4x4(matrix), channels(color.tint), static_cast<float>(color.flash) / 255.0f,
+                   channels(color.multiply));
+    }
+
+private:
+    SpiritBatch& batch;
+
+    // 0xAARRGGBB as rgba in [0, 1]
+    static QVector4D channels(const uint32_t color)
+    {
+        return {
+            static_cast<float>(color >> 16 & 0xFF) / 255.0f,
+            static_cast<float>(color >> 8 & 0xFF) / 255.0f,
+            static_cast<float>(color & 0xFF) / 255.0f,
+            static_cast<float>(color >> 24) / 255.0f
+        };
+    }
+};
+
+#endif //SPIRITBATCHBACKEND_H
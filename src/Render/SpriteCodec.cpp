@@ -0,0 +1,205 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "SpriteCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPRITE_CODEC_SSE2
+#endif
+
+namespace
+{
+    // Shorter runs take no less room as part of a literal
+    constexpr int minRun = 3;
+    constexpr size_t maxPalette = 256;
+
+    // Pixels equal to row[x] from x on
+    int runLength(const uint32_t* row, const int x, const int width)
+    {
+        const uint32_t pixel = row[x];
+        int end = x + 1;
+#ifdef SPRITE_CODEC_SSE2
+        const __m128i value = _mm_set1_epi32(static_cast<int>(pixel));
+        while (end + 4 <= width &&
+            _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + end)), value)) ==
+            0xFFFF)
+        {
+            end += 4;
+        }
+#endif
+        while (end < width && row[end] == pixel)
+        {
+            end++;
+        }
+        return end - x;
+    }
+
+    void fill(uint32_t* out, uint32_t count, const uint32_t pixel)
+    {
+#ifdef SPRITE_CODEC_SSE2
+        const __m128i value = _mm_set1_epi32(static_cast<int>(pixel));
+        for (; count >= 4; count -= 4, out += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), value);
+        }
+#endif
+        std::fill_n(out, count, pixel);
+    }
+
+    void writeVarint(std::vector<uint8_t>& data, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t readVarint(const uint8_t*& in)
+    {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            const uint8_t byte = *in++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+    }
+
+    // Index of every colour of the image, empty when there are too many for a byte
+    std::unordered_map<uint32_t, uint8_t> paletteOf(const QImage& source)
+    {
+        std::unordered_map<uint32_t, uint8_t> indices;
+        for (int y = 0; y < source.height(); y++)
+        {
+            const auto row = reinterpret_cast<const uint32_t*>(source.constScanLine(y));
+            for (int x = 0; x < source.width(); x++)
+            {
+                if (indices.try_emplace(row[x], static_cast<uint8_t>(indices.size())).second &&
+                    indices.size() > maxPalette)
+                {
+                    return {};
+                }
+            }
+        }
+        return indices;
+    }
+}
+
+SpriteCodec::Packed SpriteCodec::pack(const QImage& image)
+{
+    if (image.isNull())
+    {
+        return {};
+    }
+    const QImage source = image.format() == QImage::Format_ARGB32_Premultiplied
+                              ? image
+                              : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const std::unordered_map<uint32_t, uint8_t> indices = paletteOf(source);
+    Packed packed{.size = source.size(), .palette = std::vector<uint32_t>(indices.size())};
+    for (const auto& [colour, index] : indices)
+    {
+        packed.palette[index] = colour;
+    }
+    const auto writePixels = [&packed, &indices](const uint32_t* pixels, const int count)
+    {
+        if (indices.empty())
+        {
+            const auto bytes = reinterpret_cast<const uint8_t*>(pixels);
+            packed.data.insert(packed.data.end(), bytes, bytes + count * sizeof(uint32_t));
+            return;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            packed.data.push_back(indices.at(pixels[i]));
+        }
+    };
+
+    const int width = source.width();
+    for (int y = 0; y < source.height(); y++)
+    {
+        const auto row = reinterpret_cast<const uint32_t*>(source.constScanLine(y));
+        int x = 0;
+        while (x < width)
+        {
+            const int run = runLength(row, x, width);
+            if (run >= minRun)
+            {
+                writeVarint(packed.data, static_cast<uint32_t>(run) << 1 | 1);
+                writePixels(row + x, 1);
+                x += run;
+                continue;
+            }
+            // Literal up to the next run worth its token
+            int end = x + run;
+            while (end < width && runLength(row, end, width) < minRun)
+            {
+                end++;
+            }
+            writeVarint(packed.data, static_cast<uint32_t>(end - x) << 1);
+            writePixels(row + x, end - x);
+            x = end;
+        }
+    }
+    packed.data.shrink_to_fit();
+    return packed;
+}
+
+QImage SpriteCodec::expand(const Packed& packed)
+{
+    if (packed.isNull())
+    {
+        return {};
+    }
+    QImage image(packed.size, QImage::Format_ARGB32_Premultiplied);
+    // Lines of 32 bit images are never padded, the rows follow each other like the tokens do
+    auto out = reinterpret_cast<uint32_t*>(image.bits());
+    const uint8_t* in = packed.data.data();
+    const uint8_t* end = in + packed.data.size();
+    const uint32_t* palette = packed.palette.data();
+    const bool indexed = !packed.palette.empty();
+    while (in < end)
+    {
+        const uint32_t token = readVarint(in);
+        const uint32_t count = token >> 1;
+        if (token & 1)
+        {
+            uint32_t pixel;
+            if (indexed)
+            {
+                pixel = palette[*in++];
+            }
+            else
+            {
+                std::memcpy(&pixel, in, sizeof(pixel));
+                in += sizeof(pixel);
+            }
+            fill(out, count, pixel);
+        }
+        else if (indexed)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                out[i] = palette[in[i]];
+            }
+            in += count;
+        }
+        else
+        {
+            std::memcpy(out, in, count * sizeof(uint32_t));
+            in += count * sizeof(uint32_t);
+        }
+        out += count;
+    }
+    return image;
+}
@@ -0,0 +1,49 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SPRITECODEC_H
+#define SPRITECODEC_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <QImage>
+#include <QSize>
+
+/*
+    Compact resident form of sprite frames: premultiplied ARGB32, run length encoded, and palette indexed when the
+    frame has no more than 256 colours, as pixel art usually does. Transparent texels and flat areas of one colour
+    collapse into runs, dithered spans are kept as literals of one byte per texel (four without a palette).
+    Every row is encoded on its own, expansion writes the rows back to back. SSE2 finds runs 4 pixels per step
+    when packing and fills them 4 pixels per store when expanding.
+*/
+namespace SpriteCodec
+{
+    struct Packed
+    {
+        QSize size;
+        // Colours the pixels index, empty when they are stored as they are
+        std::vector<uint32_t> palette;
+        // Tokens, each a varint of the pixel count shifted left once with the low bit set for a run. A run is
+        // followed by its pixel, a literal by its pixels
+        std::vector<uint8_t> data;
+
+        bool isNull() const
+        {
+            return data.empty();
+        }
+
+        size_t bytes() const
+        {
+            return palette.size() * sizeof(uint32_t) + data.size();
+        }
+    };
+
+    // Converted to premultiplied ARGB32 first if needed. Views into atlas pages are read row by row
+    Packed pack(const QImage& image);
+
+    // Premultiplied ARGB32 image of the packed pixels, null for a null Packed
+    QImage expand(const Packed& packed);
+}
+
+#endif //SPRITECODEC_H
@@ -0,0 +1,154 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "SpriteTrim.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPRITE_TRIM_SSE2
+#endif
+
+namespace
+{
+    bool clear(const uint32_t pixel)
+    {
+        return pixel >> 24 == 0;
+    }
+
+#ifdef SPRITE_TRIM_SSE2
+    // The 4 pixels at pixels all have a zero alpha
+    bool clear4(const uint32_t* pixels)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(values, alpha), _mm_setzero_si128())) == 0xFFFF;
+    }
+#endif
+
+    // Column of the first visible pixel of a row, width for a clear row
+    int firstVisible(const uint32_t* row, const int width)
+    {
+        int x = 0;
+#ifdef SPRITE_TRIM_SSE2
+        while (x + 4 <= width && clear4(row + x))
+        {
+            x += 4;
+        }
+#endif
+        while (x < width && clear(row[x]))
+        {
+            x++;
+        }
+        return x;
+    }
+
+    // One past the column of the last visible pixel of a row, 0 for a clear row
+    int lastVisible(const uint32_t* row, const int width)
+    {
+        int x = width;
+#ifdef SPRITE_TRIM_SSE2
+        while (x >= 4 && clear4(row + x - 4))
+        {
+            x -= 4;
+        }
+#endif
+        while (x > 0 && clear(row[x - 1]))
+        {
+            x--;
+        }
+        return x;
+    }
+}
+
+QRect SpriteTrim::opaqueBounds(const QImage& image)
+{
+    if (image.isNull())
+    {
+        return {};
+    }
+    if (!image.hasAlphaChannel())
+    {
+        return image.rect();
+    }
+    const QImage source = image.format() == QImage::Format_ARGB32 ||
+                          image.format() == QImage::Format_ARGB32_Premultiplied
+                              ? image
+                              : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int width = source.width();
+    int top = -1;
+    int bottom = -1;
+    int left = width;
+    int right = 0;
+    for (int y = 0; y < source.height(); y++)
+    {
+        const auto row = reinterpret_cast<const uint32_t*>(source.constScanLine(y));
+        const int first = firstVisible(row, width);
+        if (first == width)
+        {
+            continue;
+        }
+        if (top < 0)
+        {
+            top = y;
+        }
+        bottom = y;
+        left = std::min(left, first);
+        right = std::max(right, lastVisible(row, width));
+    }
+    return top < 0 ? QRect() : QRect(left, top, right - left, bottom - top + 1);
+}
+
+SpriteTrim::Trim SpriteTrim::trim(QImage& image)
+{
+    const QRect bounds = opaqueBounds(image);
+    if (bounds.isEmpty() || bounds == image.rect())
+    {
+        return Trim{.canvas = image.size()};
+    }
+    Trim result{.canvas = image.size(), .rect = bounds};
+    image = image.copy(bounds);
+    return result;
+}
+
+Texture::Config SpriteTrim::config(const Texture::Config& config, const Trim& trim)
+{
+    Texture::Config result = config;
+    if (trim.isTrimmed())
+    {
+        result.scale = static_cast<float>(config.scale) * static_cast<float>(trim.rect.height()) /
+            static_cast<float>(trim.canvas.height());
+    }
+    return result;
+}
+
+QPointF SpriteTrim::offset(const Trim& trim, const float height)
+{
+    if (!trim.isTrimmed())
+    {
+        return {};
+    }
+    const double unitsPerTexel = height / trim.canvas.height();
+    const QPointF centre = QRectF(trim.rect).center();
+    return {
+        (centre.x() - trim.canvas.width() / 2.0) * unitsPerTexel,
+        (trim.canvas.height() / 2.0 - centre.y()) * unitsPerTexel
+    };
+}
+
+QRectF SpriteTrim::place(const Trim& trim, const QRectF& target)
+{
+    if (!trim.isTrimmed())
+    {
+        return target;
+    }
+    const double scaleX = target.width() / trim.canvas.width();
+    const double scaleY = target.height() / trim.canvas.height();
+    return {
+        target.x() + trim.rect.x() * scaleX, target.y() + trim.rect.y() * scaleY,
+        trim.rect.width() * scaleX, trim.rect.height() * scaleY
+    };
+}
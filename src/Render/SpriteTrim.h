@@ -0,0 +1,55 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SPRITETRIM_H
+#define SPRITETRIM_H
+#include <QImage>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+
+#include "Texture.h"
+
+/*
+    Cropping of the fully transparent border around sprite frames. Frames are often padded to a shared canvas
+    (utils/cut_image.py does it on purpose), the padding costs memory, atlas space and fill rate for nothing.
+    A trimmed texture keeps only its opaque bounding box, the Trim remembers the canvas and where the box sat in
+    it so the sprite is still drawn at the same place and size: the texture gets a proportionally smaller
+    Texture::Config::scale and is drawn offset() from the centre of its entity.
+*/
+namespace SpriteTrim
+{
+    struct Trim
+    {
+        // Size of the source image and the part of it that was kept, an empty rect when nothing was cut
+        QSize canvas;
+        QRect rect;
+
+        bool isTrimmed() const
+        {
+            return !rect.isEmpty();
+        }
+    };
+
+    // Smallest rect holding every pixel with a non zero alpha, empty for an image without any.
+    // ARGB32 formats are scanned in place (4 pixels per step with SSE2), others converted first
+    QRect opaqueBounds(const QImage& image);
+
+    // Crops image to its opaque bounds. Left as it is, with an untrimmed result, when there is no border to cut
+    // or no opaque pixel at all
+    Trim trim(QImage& image);
+
+    // Config of the kept rect, so its texels are as large on screen as those of the canvas drawn with config
+    Texture::Config config(const Texture::Config& config, const Trim& trim);
+
+    // Centre of the kept rect relative to the centre of the canvas, in world units of a canvas height units high
+    // (y up)
+    QPointF offset(const Trim& trim, float height);
+
+    // Where the kept rect lands when the whole canvas is drawn into target
+    QRectF place(const Trim& trim, const QRectF& target);
+}
+
+#endif //SPRITETRIM_H
@@ -0,0 +1,231 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    constexpr QImage::Format pageFormat = QImage::Format_ARGB32_Premultiplied;
+    constexpr int bytesPerPixel = 4;
+
+    // Bottom-left skyline: the top edge of the packed area is kept as a list of horizontal segments and each
+    // rectangle goes where its top ends lowest, ties broken by the narrowest segment
+    class SkylinePacker
+    {
+    public:
+        SkylinePacker(const int width, const int height) : width(width), height(height), nodes{{0, 0, width}}
+        {
+        }
+
+        bool insert(const int w, const int h, QPoint& position)
+        {
+            size_t bestIndex = SIZE_MAX;
+            int bestTop = INT_MAX;
+            int bestWidth = INT_MAX;
+            int bestY = 0;
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                int y;
+                if (!fits(i, w, h, y))
+                {
+                    continue;
+                }
+                if (y + h < bestTop || (y + h == bestTop && nodes[i].width < bestWidth))
+                {
+                    bestIndex = i;
+                    bestTop = y + h;
+                    bestWidth = nodes[i].width;
+                    bestY = y;
+                }
+            }
+            if (bestIndex == SIZE_MAX)
+            {
+                return false;
+            }
+
+            position = QPoint(nodes[bestIndex].x, bestY);
+            nodes.insert(nodes.begin() + static_cast<ptrdiff_t>(bestIndex), Node{position.x(), bestY + h, w});
+            // Cut the segments now covered by the new one
+            for (size_t i = bestIndex + 1; i < nodes.size();)
+            {
+                const Node& previous = nodes[i - 1];
+                Node& node = nodes[i];
+                if (node.x >= previous.x + previous.width)
+                {
+                    break;
+                }
+                const int overlap = previous.x + previous.width - node.x;
+                node.x += overlap;
+                node.width -= overlap;
+                if (node.width > 0)
+                {
+                    break;
+                }
+                nodes.erase(nodes.begin() + static_cast<ptrdiff_t>(i));
+            }
+            for (size_t i = 0; i + 1 < nodes.size();)
+            {
+                if (nodes[i].y == nodes[i + 1].y)
+                {
+                    nodes[i].width += nodes[i + 1].width;
+                    nodes.erase(nodes.begin() + static_cast<ptrdiff_t>(i + 1));
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            usedWidth = std::max(usedWidth, position.x() + w);
+            usedHeight = std::max(usedHeight, bestY + h);
+            return true;
+        }
+
+        int usedWidth = 0;
+        int usedHeight = 0;
+
+    private:
+        struct Node
+        {
+            int x, y, width;
+        };
+
+        int width;
+        int height;
+        std::vector<Node> nodes;
+
+        bool fits(size_t index, const int w, const int h, int& y) const
+        {
+            if (nodes[index].x + w > width)
+            {
+                return false;
+            }
+            y = 0;
+            for (int remaining = w; remaining > 0; index++)
+            {
+                if (index == nodes.size())
+                {
+                    return false;
+                }
+                y = std::max(y, nodes[index].y);
+                if (y + h > height)
+                {
+                    return false;
+                }
+                remaining -= nodes[index].width;
+            }
+            return true;
+        }
+    };
+}
+
+std::vector<TextureAtlas::Region> TextureAtlas::build(const std::vector<QImage>& images)
+{
+    std::vector<Region> regions(images.size());
+
+    // Tallest first packs a skyline noticeably tighter
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&images](const size_t lhs, const size_t rhs)
+    {
+        const QSize a = images[lhs].size();
+        const QSize b = images[rhs].size();
+        return a.height() != b.height() ? a.height() > b.height() : a.width() > b.width();
+    });
+
+    SkylinePacker packer(pageSize, pageSize);
+    std::vector<std::pair<size_t, QPoint>> packed;
+    std::vector<std::pair<size_t, QRect>> rects;
+    const auto flush = [&]
+    {
+        if (packed.empty())
+        {
+            return;
+        }
+        // Pages are cropped to what the group actually used
+        QImage page(packer.usedWidth, packer.usedHeight, pageFormat);
+        page.fill(Qt::transparent);
+        const auto pageIndex = static_cast<uint32_t>(pages.size());
+        for (const auto& [index, position] : packed)
+        {
+            const QImage source = images[index].convertToFormat(pageFormat);
+            for (int row = 0; row < source.height(); row++)
+            {
+                std::memcpy(page.scanLine(position.y() + row) + position.x() * bytesPerPixel,
+                            source.constScanLine(row), static_cast<size_t>(source.width()) * bytesPerPixel);
+            }
+            rects.emplace_back(index, QRect(position, source.size()));
+        }
+        pages.push_back(std::move(page));
+        for (const auto& [index, rect] : rects)
+        {
+            regions[index] = region(pageIndex, rect);
+        }
+        rects.clear();
+        packed.clear();
+        packer = SkylinePacker(pageSize, pageSize);
+    };
+
+    for (const size_t index : order)
+    {
+        const QImage& image = images[index];
+        const int w = image.width() + 2 * padding;
+        const int h = image.height() + 2 * padding;
+        if (image.isNull() || w > pageSize || h > pageSize)
+        {
+            continue;
+        }
+        QPoint position;
+        if (!packer.insert(w, h, position))
+        {
+            flush();
+            packer.insert(w, h, position);
+        }
+        packed.emplace_back(index, position + QPoint(padding, padding));
+    }
+    flush();
+    return regions;
+}
+
+QImage TextureAtlas::view(const Region& region) const
+{
+    const QImage& page = pages.at(region.page);
+    const qsizetype stride = page.bytesPerLine();
+    const uchar* data = page.constBits() + region.rect.y() * stride + region.rect.x() * bytesPerPixel;
+    // Read only, a write detaches the view instead of touching the page
+    return QImage(data, region.rect.width(), region.rect.height(), stride, page.format());
+}
+
+uint32_t TextureAtlas::adopt(const QImage& page)
+{
+    assert(page.format() == pageFormat);
+    pages.push_back(page);
+    return static_cast<uint32_t>(pages.size() - 1);
+}
+
+TextureAtlas::Region TextureAtlas::region(const uint32_t page, const QRect& rect) const
+{
+    const QSizeF extent = pages.at(page).size();
+    return Region{
+        .page = page,
+        .rect = rect,
+        .uv = QRectF(rect.x() / extent.width(), rect.y() / extent.height(),
+                     rect.width() / extent.width(), rect.height() / extent.height())
+    };
+}
+
+void TextureAtlas::release(const uint32_t page)
+{
+    pages.at(page) = QImage();
+}
+
+void TextureAtlas::clear()
+{
+    pages.clear();
+}
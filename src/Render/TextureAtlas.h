@@ -0,0 +1,68 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+#include <cstdint>
+#include <vector>
+#include <QImage>
+#include <QRect>
+
+/*
+    Packs many small images into shared premultiplied ARGB32 pages with a skyline bottom-left packer.
+    Every call to build() packs one group (the frames of a directory) into pages of its own, so a group's
+    sprites sit together and pages never change once built. Images are views into the page memory,
+    the pages must outlive them.
+*/
+class TextureAtlas
+{
+public:
+    constexpr static uint32_t noPage = UINT32_MAX;
+    constexpr static int pageSize = 2048;
+    // Transparent gutter around each image so filtering never samples a neighbour
+    constexpr static int padding = 1;
+
+    struct Region
+    {
+        uint32_t page = noPage;
+        // Pixels in the page
+        QRect rect;
+        // Normalised texture coordinates of rect
+        QRectF uv;
+    };
+
+    // Packs images into new pages, regions[i] tells where images[i] went.
+    // Images too large for a page get a region with page == noPage and are left to the caller
+    std::vector<Region> build(const std::vector<QImage>& images);
+
+    // Registers a page built elsewhere (e.g. mapped from the asset pack), premultiplied ARGB32
+    uint32_t adopt(const QImage& page);
+
+    // Region of rect inside a page, with its texture coordinates
+    Region region(uint32_t page, const QRect& rect) const;
+
+    // Read only image sharing the pixels of region inside its page
+    QImage view(const Region& region) const;
+
+    const QImage& page(uint32_t index) const
+    {
+        return pages.at(index);
+    }
+
+    size_t pageCount() const
+    {
+        return pages.size();
+    }
+
+    // Frees the pixels of a page no view refers to any more, its index is not reused
+    void release(uint32_t page);
+
+    void clear();
+
+private:
+    std::vector<QImage> pages;
+};
+
+
+#endif //TEXTUREATLAS_H
@@ -0,0 +1,207 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "TransformKernel.h"
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_KERNEL_SSE2
+#endif
+
+// The kernels read a Transform as 6 packed floats
+static_assert(offsetof(Transform, position) == 0);
+static_assert(offsetof(Transform, rotation) == 2 * sizeof(float));
+static_assert(offsetof(Transform, scale) == 4 * sizeof(float));
+static_assert(offsetof(Transform, z) == 5 * sizeof(float));
+static_assert(sizeof(Transform) == 6 * sizeof(float));
+
+namespace
+{
+    constexpr size_t stride = sizeof(Transform) / sizeof(float);
+}
+
+void TransformKernel::toMatricesScalar(const Transform* transforms, const size_t count, float* matrices)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const Transform& t = transforms[i];
+        const float scaleX = t.scale;
+        const float scaleY = std::abs(t.scale);
+        float* m = matrices + i * matrixSize;
+        m[0] = scaleX * t.rotation.c;
+        m[1] = scaleY * t.rotation.s;
+        m[2] = 0;
+        m[3] = t.position.x;
+        m[4] = -scaleX * t.rotation.s;
+        m[5] = scaleY * t.rotation.c;
+        m[6] = 0;
+        m[7] = t.position.y;
+        m[8] = 0;
+        m[9] = 0;
+        m[10] = 1;
+        m[11] = t.z;
+        m[12] = 0;
+        m[13] = 0;
+        m[14] = 0;
+        m[15] = 1;
+    }
+}
+
+#if defined(TRANSFORM_KERNEL_AVX2)
+
+namespace
+{
+    inline void transpose8(__m256& r0, __m256& r1, __m256& r2, __m256& r3,
+                           __m256& r4, __m256& r5, __m256& r6, __m256& r7)
+    {
+        const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+        const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+        const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+        const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+        const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+        const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+        const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+        r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+        r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+        r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+        r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+        r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+        r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+        r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+    }
+}
+
+void TransformKernel::toMatrices(const Transform* transforms, const size_t count, float* matrices)
+{
+    const auto data = reinterpret_cast<const float*>(transforms);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i index = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(stride));
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    // Lower half of rows 2 and 3 of every matrix: 0 0 1 z 0 0 0 1, z blended in per lane
+    const __m256 tail = _mm256_setr_ps(0, 0, 1, 0, 0, 0, 0, 1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const float* base = data + i * stride;
+        const __m256 px = _mm256_i32gather_ps(base + 0, index, 4);
+        const __m256 py = _mm256_i32gather_ps(base + 1, index, 4);
+        const __m256 c = _mm256_i32gather_ps(base + 2, index, 4);
+        const __m256 s = _mm256_i32gather_ps(base + 3, index, 4);
+        const __m256 scaleX = _mm256_i32gather_ps(base + 4, index, 4);
+        const __m256 z = _mm256_i32gather_ps(base + 5, index, 4);
+        const __m256 scaleY = _mm256_andnot_ps(signMask, scaleX);
+
+        // One register per matrix cell of the first two rows, one lane per transform
+        __m256 r0 = _mm256_mul_ps(scaleX, c);
+        __m256 r1 = _mm256_mul_ps(scaleY, s);
+        __m256 r2 = zero;
+        __m256 r3 = px;
+        __m256 r4 = _mm256_xor_ps(_mm256_mul_ps(scaleX, s), signMask);
+        __m256 r5 = _mm256_mul_ps(scaleY, c);
+        __m256 r6 = zero;
+        __m256 r7 = py;
+        transpose8(r0, r1, r2, r3, r4, r5, r6, r7);
+
+        alignas(32) float depth[8];
+        _mm256_store_ps(depth, z);
+        float* out = matrices + i * matrixSize;
+        const __m256 rows[8] = {r0, r1, r2, r3, r4, r5, r6, r7};
+        for (int k = 0; k < 8; k++)
+        {
+            _mm256_storeu_ps(out + k * matrixSize, rows[k]);
+            _mm256_storeu_ps(out + k * matrixSize + 8, _mm256_blend_ps(tail, _mm256_set1_ps(depth[k]), 0x08));
+        }
+    }
+    toMatricesScalar(transforms + i, count - i, matrices + i * matrixSize);
+}
+
+const char* TransformKernel::implementation()
+{
+    return "avx2";
+}
+
+#elif defined(TRANSFORM_KERNEL_SSE2)
+
+void TransformKernel::toMatrices(const Transform* transforms, const size_t count, float* matrices)
+{
+    const auto data = reinterpret_cast<const float*>(transforms);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lastRow = _mm_setr_ps(0, 0, 0, 1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* base = data + i * stride;
+        // px py c s of each transform, transposed into one register per field
+        __m128 px = _mm_loadu_ps(base);
+        __m128 py = _mm_loadu_ps(base + stride);
+        __m128 c = _mm_loadu_ps(base + 2 * stride);
+        __m128 s = _mm_loadu_ps(base + 3 * stride);
+        _MM_TRANSPOSE4_PS(px, py, c, s);
+        const __m128 scaleX = _mm_setr_ps(base[4], base[stride + 4], base[2 * stride + 4], base[3 * stride + 4]);
+        const __m128 scaleY = _mm_andnot_ps(signMask, scaleX);
+
+        __m128 r0 = _mm_mul_ps(scaleX, c);
+        __m128 r1 = _mm_mul_ps(scaleY, s);
+        __m128 r2 = zero;
+        __m128 r3 = px;
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        __m128 r4 = _mm_xor_ps(_mm_mul_ps(scaleX, s), signMask);
+        __m128 r5 = _mm_mul_ps(scaleY, c);
+        __m128 r6 = zero;
+        __m128 r7 = py;
+        _MM_TRANSPOSE4_PS(r4, r5, r6, r7);
+
+        float* out = matrices + i * matrixSize;
+        const __m128 firstRows[4] = {r0, r1, r2, r3};
+        const __m128 secondRows[4] = {r4, r5, r6, r7};
+        for (int k = 0; k < 4; k++)
+        {
+            float* m = out + k * matrixSize;
+            _mm_storeu_ps(m, firstRows[k]);
+            _mm_storeu_ps(m + 4, secondRows[k]);
+            _mm_storeu_ps(m + 8, _mm_setr_ps(0, 0, 1, base[k * stride + 5]));
+            _mm_storeu_ps(m + 12, lastRow);
+        }
+    }
+    toMatricesScalar(transforms + i, count - i, matrices + i * matrixSize);
+}
+
+const char* TransformKernel::implementation()
+{
+    return "sse2";
+}
+
+#else
+
+void TransformKernel::toMatrices(const Transform* transforms, const size_t count, float* matrices)
+{
+    toMatricesScalar(transforms, count, matrices);
+}
+
+const char* TransformKernel::implementation()
+{
+    return "scalar";
+}
+
+#endif
@@ -0,0 +1,31 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef TRANSFORMKERNEL_H
+#define TRANSFORMKERNEL_H
+#include <cstddef>
+
+#include "../Components/Transform.h"
+
+/*
+    Batch conversion of packed Transforms into render matrices.
+    Output matrices are 16 row-major floats each, the same values Transform::toMatrix produces, ready for
+    QMatrix4x4(const float*). Built with AVX2 (8 transforms per step) when LUCKNIGHT_AVX2 is on, SSE2
+    (4 per step) on any other x86-64 build and a scalar loop everywhere else.
+*/
+namespace TransformKernel
+{
+    constexpr size_t matrixSize = 16;
+
+    // Vectorised conversion, matrices must hold count * matrixSize floats
+    void toMatrices(const Transform* transforms, size_t count, float* matrices);
+
+    // Reference implementation, also used for the tail of the vectorised loop
+    void toMatricesScalar(const Transform* transforms, size_t count, float* matrices);
+
+    // Name of the path toMatrices was compiled with
+    const char* implementation();
+}
+
+#endif //TRANSFORMKERNEL_H
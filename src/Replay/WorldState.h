@@ -0,0 +1,71 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef WORLDSTATE_H
+#define WORLDSTATE_H
+#include <cstdint>
+#include <unordered_map>
+
+#include "../Type/SpriteColor.h"
+
+// Wire level description of the replicated part of an entity, shared by the encoder and the decoder
+namespace WorldState
+{
+    constexpr uint32_t frameMagic = 0x4C4B5753; // "SWKL"
+    constexpr int positionBits = 8; // positions are stored in 1/256 world units
+    constexpr float positionScale = 1 << positionBits;
+    constexpr float angleScale = 65536.0f / 6.28318530718f;
+    constexpr uint32_t noTexture = 0;
+
+    enum ComponentBits : uint32_t
+    {
+        HasTransform = 1 << 0,
+        HasDrawable = 1 << 1,
+        HasAnimator = 1 << 2,
+        HasStatusPlayer = 1 << 3,
+        HasStatusProjectile = 1 << 4,
+        HasStatusWeapon = 1 << 5,
+    };
+
+    constexpr int componentCount = 6;
+
+    struct EntityState
+    {
+        uint32_t components = 0;
+
+        // Transform, quantised
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t z = 0;
+        uint16_t angle = 0;
+        bool flipped = false;
+
+        // Drawable, index in the texture table
+        uint32_t texture = noTexture;
+        SpriteColor color;
+
+        // Animator
+        int32_t frame = 0;
+
+        // StatusPlayer
+        float health = 0;
+
+        // StatusProjectile
+        float damage = 0;
+        float lifeLeft = 0;
+
+        // StatusWeapon
+        int32_t ammoLeft = 0;
+        float accuracy = 0;
+        float delay = 0;
+        float delayLeft = 0;
+
+        bool operator==(const EntityState&) const = default;
+    };
+
+    // Keyed by the integral value of the entity on the encoding side
+    typedef std::unordered_map<uint32_t, EntityState> Snapshot;
+}
+
+#endif //WORLDSTATE_H
@@ -0,0 +1,320 @@
+//
+// Created by root on 7/9/25.
+//
+
+#include "WorldStateDecoder.h"
+
+#include <cmath>
+#include <QtEndian>
+
+#include "../Components/Animator.h"
+#include "../Components/Drawable.h"
+#include "../Components/Status.h"
+#include "../Components/Transform.h"
+#include "../Managers/TextureManager.h"
+#include "../Type/Errors.h"
+
+using namespace WorldState;
+
+WorldStateDecoder::WorldStateDecoder(QIODevice* device, entt::registry& registry): device(device), registry(registry)
+{
+    assert(device && device->isReadable());
+}
+
+uint32_t WorldStateDecoder::lastAppliedTick() const
+{
+    return lastTick;
+}
+
+bool WorldStateDecoder::fill(const qsizetype size)
+{
+    while (buffer.size() < size)
+    {
+        const QByteArray chunk = device->read(size - buffer.size());
+        if (chunk.isEmpty())
+        {
+            return false;
+        }
+        buffer += chunk;
+    }
+    return true;
+}
+
+bool WorldStateDecoder::decodeNext()
+{
+    constexpr qsizetype headerSize = 8;
+    if (!fill(headerSize))
+    {
+        return false;
+    }
+    const auto header = reinterpret_cast<const uchar*>(buffer.constData());
+    if (qFromLittleEndian<quint32>(header) != frameMagic)
+    {
+        throw StreamFormatException("WorldStateDecoder: bad frame magic");
+    }
+    const qsizetype payloadSize = qFromLittleEndian<quint32>(header + 4);
+    if (!fill(headerSize + payloadSize))
+    {
+        return false;
+    }
+
+    BitReader reader(reinterpret_cast<const uint8_t*>(buffer.constData()) + headerSize, payloadSize);
+    decodeFrame(reader);
+    if (reader.failed())
+    {
+        throw StreamFormatException("WorldStateDecoder: truncated frame");
+    }
+    buffer.remove(0, headerSize + payloadSize);
+    return true;
+}
+
+void WorldStateDecoder::readTextureTable(BitReader& reader)
+{
+    const uint32_t count = reader.readVarUInt();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t id = reader.readVarUInt();
+        const float scale = reader.readFloat();
+        const uint32_t length = reader.readVarUInt();
+        if (length > reader.bitsLeft() / 8)
+        {
+            throw StreamFormatException("WorldStateDecoder: texture path longer than its frame");
+        }
+        std::string path(length, '\0');
+        for (char& c : path)
+        {
+            c = static_cast<char>(reader.readBits(8));
+        }
+        if (textures.contains(id))
+        {
+            continue;
+        }
+        textures[id] = path.empty() ? TextureHandle() : TextureManager::getInstance().getTexture(path, {.scale = scale});
+    }
+}
+
+EntityState WorldStateDecoder::readEntity(BitReader& reader, const EntityState* previous)
+{
+    static const EntityState empty;
+    EntityState state;
+    state.components = reader.readBits(componentCount);
+
+    auto baseFor = [&](const uint32_t component) -> const EntityState&
+    {
+        return previous && (previous->components & component) ? *previous : empty;
+    };
+    auto readFloatIfChanged = [&reader](float& value, const float base)
+    {
+        value = reader.readBool() ? reader.readFloat() : base;
+    };
+
+    if (state.components & HasTransform)
+    {
+        const EntityState& base = baseFor(HasTransform);
+        state.x = base.x;
+        state.y = base.y;
+        if (reader.readBool())
+        {
+            state.x += reader.readVarInt();
+            state.y += reader.readVarInt();
+        }
+        state.z = base.z;
+        if (reader.readBool())
+        {
+            state.z += reader.readVarInt();
+        }
+        state.angle = reader.readBool() ? static_cast<uint16_t>(reader.readBits(16)) : base.angle;
+        state.flipped = reader.readBool();
+    }
+    if (state.components & HasDrawable)
+    {
+        const EntityState& base = baseFor(HasDrawable);
+        state.texture = reader.readBool() ? reader.readVarUInt() : base.texture;
+        state.color = base.color;
+        if (reader.readBool())
+        {
+            state.color.multiply = reader.readBits(32);
+            state.color.tint = reader.readBits(32);
+            state.color.flash = static_cast<uint8_t>(reader.readBits(8));
+        }
+    }
+    if (state.components & HasAnimator)
+    {
+        const EntityState& base = baseFor(HasAnimator);
+        state.frame = base.frame;
+        if (reader.readBool())
+        {
+            state.frame += reader.readVarInt();
+        }
+    }
+    if (state.components & HasStatusPlayer)
+    {
+        const EntityState& base = baseFor(HasStatusPlayer);
+        readFloatIfChanged(state.health, base.health);
+    }
+    if (state.components & HasStatusProjectile)
+    {
+        const EntityState& base = baseFor(HasStatusProjectile);
+        readFloatIfChanged(state.damage, base.damage);
+        readFloatIfChanged(state.lifeLeft, base.lifeLeft);
+    }
+    if (state.components & HasStatusWeapon)
+    {
+        const EntityState& base = baseFor(HasStatusWeapon);
+        state.ammoLeft = base.ammoLeft;
+        if (reader.readBool())
+        {
+            state.ammoLeft += reader.readVarInt();
+        }
+        readFloatIfChanged(state.accuracy, base.accuracy);
+        readFloatIfChanged(state.delay, base.delay);
+        readFloatIfChanged(state.delayLeft, base.delayLeft);
+    }
+    return state;
+}
+
+void WorldStateDecoder::decodeFrame(BitReader& reader)
+{
+    const bool keyframe = reader.readBool();
+    const uint32_t tick = reader.readBits(32);
+
+    Snapshot next;
+    if (!keyframe)
+    {
+        const uint32_t baselineTick = reader.readBits(32);
+        const auto it = history.find(baselineTick);
+        if (it == history.end())
+        {
+            throw StreamFormatException("WorldStateDecoder: frame references an unknown baseline");
+        }
+        // The encoder never diffs against anything older than this again
+        history.erase(history.begin(), it);
+        next = it->second;
+    }
+    readTextureTable(reader);
+
+    const uint32_t removedCount = reader.readVarUInt();
+    for (uint32_t i = 0; i < removedCount; i++)
+    {
+        next.erase(reader.readVarUInt());
+    }
+    const uint32_t changedCount = reader.readVarUInt();
+    for (uint32_t i = 0; i < changedCount; i++)
+    {
+        const uint32_t id = reader.readVarUInt();
+        const auto it = next.find(id);
+        next[id] = readEntity(reader, it == next.end() ? nullptr : &it->second);
+    }
+
+    // Unlisted entities equal the baseline, which is not necessarily what we applied last, so diff the
+    // reconstructed frame against the registry mirror instead of applying only the listed changes
+    for (auto it = entities.begin(); it != entities.end();)
+    {
+        if (!next.contains(it->first))
+        {
+            if (registry.valid(it->second))
+            {
+                registry.destroy(it->second);
+            }
+            it = entities.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (const auto& [id, state] : next)
+    {
+        const auto it = current.find(id);
+        if (it == current.end() || !(it->second == state))
+        {
+            apply(id, state);
+        }
+    }
+
+    current = next;
+    history[tick] = std::move(next);
+    lastTick = tick;
+}
+
+void WorldStateDecoder::apply(const uint32_t id, const EntityState& state)
+{
+    auto [it, inserted] = entities.try_emplace(id, entt::null);
+    if (inserted || !registry.valid(it->second))
+    {
+        it->second = registry.create();
+    }
+    const entt::entity entity = it->second;
+
+    if (state.components & HasTransform)
+    {
+        const float angle = static_cast<float>(static_cast<int16_t>(state.angle)) / angleScale;
+        registry.emplace_or_replace<Transform>(entity, Transform{
+                                                   .position = {
+                                                       static_cast<float>(state.x) / positionScale,
+                                                       static_cast<float>(state.y) / positionScale
+                                                   },
+                                                   .rotation = {std::cos(angle), std::sin(angle)},
+                                                   .scale = state.flipped ? -1.0f : 1.0f,
+                                                   .z = static_cast<float>(state.z) / positionScale
+                                               });
+    }
+    else
+    {
+        registry.remove<Transform>(entity);
+    }
+
+    const auto texture = textures.find(state.texture);
+    if ((state.components & HasDrawable) && texture != textures.end() && texture->second)
+    {
+        registry.emplace_or_replace<Drawable>(entity, Drawable{.texture = texture->second, .color = state.color});
+    }
+    else
+    {
+        registry.remove<Drawable>(entity);
+    }
+
+    if (state.components & HasAnimator)
+    {
+        registry.get_or_emplace<Animator>(entity).currentFrame = state.frame;
+    }
+    else
+    {
+        registry.remove<Animator>(entity);
+    }
+
+    if (state.components & HasStatusPlayer)
+    {
+        registry.get_or_emplace<StatusPlayer>(entity).health = state.health;
+    }
+    else
+    {
+        registry.remove<StatusPlayer>(entity);
+    }
+
+    if (state.components & HasStatusProjectile)
+    {
+        registry.emplace_or_replace<StatusProjectile>(entity, StatusProjectile{
+                                                          .damage = state.damage, .lifeLeft = state.lifeLeft
+                                                      });
+    }
+    else
+    {
+        registry.remove<StatusProjectile>(entity);
+    }
+
+    if (state.components & HasStatusWeapon)
+    {
+        registry.emplace_or_replace<StatusWeapon>(entity, StatusWeapon{
+                                                      .ammoLeft = state.ammoLeft,
+                                                      .accuracy = state.accuracy,
+                                                      .delay = state.delay,
+                                                      .delayLeft = state.delayLeft,
+                                                      .ammoType = nullptr
+                                                  });
+    }
+    else
+    {
+        registry.remove<StatusWeapon>(entity);
+    }
+}
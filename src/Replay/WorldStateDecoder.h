@@ -0,0 +1,56 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef WORLDSTATEDECODER_H
+#define WORLDSTATEDECODER_H
+#include <map>
+#include <unordered_map>
+#include <QByteArray>
+#include <QIODevice>
+
+#include "../Managers/TextureHandle.h"
+#include "WorldState.h"
+#include "../Utils/BitStream.h"
+#include "entt/entity/registry.hpp"
+
+/*
+    Client side half of the spectator/replay stream.
+    Reads the frames written by WorldStateEncoder and mirrors the replicated components into a registry,
+    so a Scene can render the match without running any system.
+*/
+class WorldStateDecoder
+{
+public:
+    WorldStateDecoder(QIODevice* device, entt::registry& registry);
+
+    // Apply the next complete frame, returns false when the device has no complete frame yet.
+    // Throws StreamFormatException on a corrupt stream
+    bool decodeNext();
+
+    // Tick of the last applied frame, to be sent back to the encoder as acknowledgement
+    uint32_t lastAppliedTick() const;
+
+private:
+    QIODevice* device;
+    entt::registry& registry;
+    QByteArray buffer;
+
+    uint32_t lastTick = 0;
+
+    // Decoded snapshots that may still be referenced as baseline by upcoming frames
+    std::map<uint32_t, WorldState::Snapshot> history;
+    WorldState::Snapshot current;
+
+    std::unordered_map<uint32_t, entt::entity> entities;
+    std::unordered_map<uint32_t, TextureHandle> textures;
+
+    bool fill(qsizetype size);
+    void decodeFrame(BitReader& reader);
+    void readTextureTable(BitReader& reader);
+    static WorldState::EntityState readEntity(BitReader& reader, const WorldState::EntityState* previous);
+    void apply(uint32_t id, const WorldState::EntityState& state);
+};
+
+
+#endif //WORLDSTATEDECODER_H
@@ -0,0 +1,333 @@
+//
+// Created by root on 7/9/25.
+//
+
+#include "WorldStateEncoder.h"
+
+#include <cmath>
+#include <QtEndian>
+
+#include "../Components/Animator.h"
+#include "../Components/Drawable.h"
+#include "../Components/Status.h"
+#include "../Components/Transform.h"
+#include "../Managers/TextureManager.h"
+
+using namespace WorldState;
+
+WorldStateEncoder::WorldStateEncoder(QIODevice* device): device(device)
+{
+    assert(device && device->isWritable());
+}
+
+void WorldStateEncoder::setAutoAcknowledge(const bool enabled)
+{
+    autoAcknowledge = enabled;
+}
+
+void WorldStateEncoder::setKeyframeInterval(const uint32_t interval)
+{
+    keyframeInterval = interval;
+}
+
+uint32_t WorldStateEncoder::currentTick() const
+{
+    return tick;
+}
+
+uint64_t WorldStateEncoder::bytesWritten() const
+{
+    return written;
+}
+
+uint32_t WorldStateEncoder::textureId(const TextureHandle& texture)
+{
+    // Baked chunks and the HUD surface have no path to be loaded from again
+    if (!texture.id())
+    {
+        return noTexture;
+    }
+    const auto [it, inserted] = textureIds.try_emplace(texture.id(), static_cast<uint32_t>(textures.size()) + 1);
+    if (inserted)
+    {
+        textures.push_back(TextureEntry{.texture = texture});
+    }
+    return it->second;
+}
+
+Snapshot WorldStateEncoder::capture(const entt::registry& registry)
+{
+    Snapshot snapshot;
+    const auto view = registry.view<const Transform>();
+    snapshot.reserve(view.size_hint());
+    for (auto [entity, transform] : view.each())
+    {
+        EntityState state;
+        state.components |= HasTransform;
+        state.x = static_cast<int32_t>(std::lround(transform.position.x * positionScale));
+        state.y = static_cast<int32_t>(std::lround(transform.position.y * positionScale));
+        state.z = static_cast<int32_t>(std::lround(transform.z * positionScale));
+        state.angle = static_cast<uint16_t>(std::lround(
+            std::atan2(transform.rotation.s, transform.rotation.c) * angleScale));
+        state.flipped = transform.scale < 0;
+
+        if (const auto drawable = registry.try_get<Drawable>(entity))
+        {
+            state.components |= HasDrawable;
+            state.texture = textureId(drawable->texture);
+            state.color = drawable->color;
+        }
+        if (const auto animator = registry.try_get<Animator>(entity))
+        {
+            state.components |= HasAnimator;
+            state.frame = animator->currentFrame;
+        }
+        if (const auto status = registry.try_get<StatusPlayer>(entity))
+        {
+            state.components |= HasStatusPlayer;
+            state.health = status->health;
+        }
+        if (const auto status = registry.try_get<StatusProjectile>(entity))
+        {
+            state.components |= HasStatusProjectile;
+            state.damage = status->damage;
+            state.lifeLeft = status->lifeLeft;
+        }
+        if (const auto status = registry.try_get<StatusWeapon>(entity))
+        {
+            state.components |= HasStatusWeapon;
+            state.ammoLeft = status->ammoLeft;
+            state.accuracy = status->accuracy;
+            state.delay = status->delay;
+            state.delayLeft = status->delayLeft;
+        }
+        snapshot.emplace(entt::to_entity(entity), state);
+    }
+    return snapshot;
+}
+
+void WorldStateEncoder::writeTextureTable(const Snapshot& snapshot, const bool keyframe)
+{
+    // Definitions are repeated until a frame carrying them is acknowledged, keyframes repeat all of them
+    std::vector<bool> listed(textures.size() + 1, false);
+    std::vector<uint32_t> definitions;
+    for (const auto& [entity, state] : snapshot)
+    {
+        if (state.texture == noTexture || listed[state.texture])
+        {
+            continue;
+        }
+        listed[state.texture] = true;
+        if (keyframe || !textures[state.texture - 1].acknowledged)
+        {
+            definitions.push_back(state.texture);
+        }
+    }
+
+    writer.writeVarUInt(static_cast<uint32_t>(definitions.size()));
+    for (const uint32_t id : definitions)
+    {
+        TextureEntry& entry = textures[id - 1];
+        const std::string name = TextureManager::getInstance().getTexturePath(entry.texture.get());
+        writer.writeVarUInt(id);
+        // As requested, the decoder loads and trims it again
+        writer.writeFloat(TextureManager::getInstance().getTextureConfig(entry.texture.get()).scale);
+        writer.writeVarUInt(static_cast<uint32_t>(name.size()));
+        for (const char c : name)
+        {
+            writer.writeBits(static_cast<uint8_t>(c), 8);
+        }
+        if (!entry.sent)
+        {
+            entry.sent = true;
+            entry.sentTick = tick;
+        }
+    }
+}
+
+void WorldStateEncoder::writeEntity(const uint32_t entity, const EntityState& state, const EntityState* previous)
+{
+    static const EntityState empty;
+    writer.writeVarUInt(entity);
+    writer.writeBits(state.components, componentCount);
+
+    // Fields are diffed against the baseline only when the baseline had the component as well
+    auto baseFor = [&](const uint32_t component) -> const EntityState&
+    {
+        return previous && (previous->components & component) ? *previous : empty;
+    };
+    auto writeFloatIfChanged = [this](const float value, const float base)
+    {
+        const bool changed = value != base;
+        writer.writeBool(changed);
+        if (changed)
+        {
+            writer.writeFloat(value);
+        }
+    };
+
+    if (state.components & HasTransform)
+    {
+        const EntityState& base = baseFor(HasTransform);
+        const bool moved = state.x != base.x || state.y != base.y;
+        writer.writeBool(moved);
+        if (moved)
+        {
+            writer.writeVarInt(state.x - base.x);
+            writer.writeVarInt(state.y - base.y);
+        }
+        const bool layered = state.z != base.z;
+        writer.writeBool(layered);
+        if (layered)
+        {
+            writer.writeVarInt(state.z - base.z);
+        }
+        const bool rotated = state.angle != base.angle;
+        writer.writeBool(rotated);
+        if (rotated)
+        {
+            writer.writeBits(state.angle, 16);
+        }
+        writer.writeBool(state.flipped);
+    }
+    if (state.components & HasDrawable)
+    {
+        const EntityState& base = baseFor(HasDrawable);
+        const bool changed = state.texture != base.texture;
+        writer.writeBool(changed);
+        if (changed)
+        {
+            writer.writeVarUInt(state.texture);
+        }
+        const bool recolored = state.color != base.color;
+        writer.writeBool(recolored);
+        if (recolored)
+        {
+            writer.writeBits(state.color.multiply, 32);
+            writer.writeBits(state.color.tint, 32);
+            writer.writeBits(state.color.flash, 8);
+        }
+    }
+    if (state.components & HasAnimator)
+    {
+        const EntityState& base = baseFor(HasAnimator);
+        const bool changed = state.frame != base.frame;
+        writer.writeBool(changed);
+        if (changed)
+        {
+            writer.writeVarInt(state.frame - base.frame);
+        }
+    }
+    if (state.components & HasStatusPlayer)
+    {
+        const EntityState& base = baseFor(HasStatusPlayer);
+        writeFloatIfChanged(state.health, base.health);
+    }
+    if (state.components & HasStatusProjectile)
+    {
+        const EntityState& base = baseFor(HasStatusProjectile);
+        writeFloatIfChanged(state.damage, base.damage);
+        writeFloatIfChanged(state.lifeLeft, base.lifeLeft);
+    }
+    if (state.components & HasStatusWeapon)
+    {
+        const EntityState& base = baseFor(HasStatusWeapon);
+        const bool changed = state.ammoLeft != base.ammoLeft;
+        writer.writeBool(changed);
+        if (changed)
+        {
+            writer.writeVarInt(state.ammoLeft - base.ammoLeft);
+        }
+        writeFloatIfChanged(state.accuracy, base.accuracy);
+        writeFloatIfChanged(state.delay, base.delay);
+        writeFloatIfChanged(state.delayLeft, base.delayLeft);
+    }
+}
+
+void WorldStateEncoder::encode(const entt::registry& registry)
+{
+    Snapshot current = capture(registry);
+
+    const bool keyframe = !hasBaseline || (keyframeInterval != 0 && tick % keyframeInterval == 0);
+    static const Snapshot none;
+    const Snapshot& base = keyframe ? none : baseline;
+
+    writer.clear();
+    writer.writeBool(keyframe);
+    writer.writeBits(tick, 32);
+    if (!keyframe)
+    {
+        writer.writeBits(baselineTick, 32);
+    }
+    writeTextureTable(current, keyframe);
+
+    std::vector<uint32_t> removed;
+    for (const auto& [entity, state] : base)
+    {
+        if (!current.contains(entity))
+        {
+            removed.push_back(entity);
+        }
+    }
+    writer.writeVarUInt(static_cast<uint32_t>(removed.size()));
+    for (const uint32_t entity : removed)
+    {
+        writer.writeVarUInt(entity);
+    }
+
+    std::vector<std::pair<uint32_t, const EntityState*>> changed;
+    for (const auto& [entity, state] : current)
+    {
+        const auto it = base.find(entity);
+        if (it == base.end() || !(it->second == state))
+        {
+            changed.emplace_back(entity, &state);
+        }
+    }
+    writer.writeVarUInt(static_cast<uint32_t>(changed.size()));
+    for (const auto& [entity, state] : changed)
+    {
+        const auto it = base.find(entity);
+        writeEntity(entity, *state, it == base.end() ? nullptr : &it->second);
+    }
+
+    const auto& payload = writer.finish();
+    uchar header[8];
+    qToLittleEndian<quint32>(frameMagic, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header + 4);
+    device->write(reinterpret_cast<const char*>(header), sizeof(header));
+    device->write(reinterpret_cast<const char*>(payload.data()), static_cast<qint64>(payload.size()));
+    written += sizeof(header) + payload.size();
+
+    pending.emplace(tick, std::move(current));
+    while (pending.size() > maxPendingFrames)
+    {
+        pending.erase(pending.begin());
+    }
+    if (autoAcknowledge)
+    {
+        acknowledge(tick);
+    }
+    ++tick;
+}
+
+void WorldStateEncoder::acknowledge(const uint32_t tick)
+{
+    const auto it = pending.find(tick);
+    if (it == pending.end() || (hasBaseline && tick <= baselineTick))
+    {
+        return;
+    }
+    baseline = std::move(it->second);
+    baselineTick = tick;
+    hasBaseline = true;
+    pending.erase(pending.begin(), std::next(it));
+
+    for (auto& entry : textures)
+    {
+        if (!entry.acknowledged && entry.sent && entry.sentTick <= tick)
+        {
+            entry.acknowledged = true;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef WORLDSTATEENCODER_H
+#define WORLDSTATEENCODER_H
+#include <map>
+#include <unordered_map>
+#include <QIODevice>
+
+#include "../Managers/TextureHandle.h"
+#include "WorldState.h"
+#include "../Utils/BitStream.h"
+#include "entt/entity/registry.hpp"
+
+/*
+    Server side half of the spectator/replay stream.
+    Every call to encode() snapshots the replicated components, diffs them against the last acknowledged
+    snapshot and writes one length prefixed, bit packed frame to the device (a socket or a file).
+    Without an acknowledged baseline the frame is a keyframe carrying the full state.
+*/
+class WorldStateEncoder
+{
+public:
+    explicit WorldStateEncoder(QIODevice* device);
+
+    // Encode and write one tick
+    void encode(const entt::registry& registry);
+
+    // The receiver has applied the frame of this tick, later frames are diffed against it
+    void acknowledge(uint32_t tick);
+
+    // Files have no back channel, every frame is treated as acknowledged once it is written
+    void setAutoAcknowledge(bool enabled);
+
+    // Force a keyframe every n ticks so replays can be joined or seeked, 0 disables
+    void setKeyframeInterval(uint32_t interval);
+
+    uint32_t currentTick() const;
+    uint64_t bytesWritten() const;
+
+private:
+    struct TextureEntry
+    {
+        // Held so the texture, and with it the id, stays valid for the whole stream
+        TextureHandle texture;
+        bool sent = false;
+        bool acknowledged = false;
+        uint32_t sentTick = 0;
+    };
+
+    // Frames we have sent but not heard back about are kept until acknowledged or too old
+    constexpr static size_t maxPendingFrames = 64;
+
+    QIODevice* device;
+    BitWriter writer;
+    uint32_t tick = 0;
+    uint32_t keyframeInterval = 0;
+    bool autoAcknowledge = false;
+    uint64_t written = 0;
+
+    bool hasBaseline = false;
+    uint32_t baselineTick = 0;
+    WorldState::Snapshot baseline;
+    std::map<uint32_t, WorldState::Snapshot> pending;
+
+    // Texture table by TextureHandle::id(), which packing and reloads leave alone unlike the Texture*. The id of a
+    // texture in the stream is its index + 1 so 0 stays free for "no texture"
+    std::unordered_map<uint32_t, uint32_t> textureIds;
+    std::vector<TextureEntry> textures;
+
+    WorldState::Snapshot capture(const entt::registry& registry);
+    uint32_t textureId(const TextureHandle& texture);
+    void writeTextureTable(const WorldState::Snapshot& snapshot, bool keyframe);
+    void writeEntity(uint32_t entity, const WorldState::EntityState& state, const WorldState::EntityState* previous);
+};
+
+
+#endif //WORLDSTATEENCODER_H
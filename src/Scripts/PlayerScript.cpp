@@ -63,7 +63,7 @@ void PlayerScript::PlayerStateMachine::Moving::onUpdate(StateMachine<PlayerScrip
         stateMachine->switchState<PlayerStateMachine::Idle>();
         return;
     }
-    param->componentTransform->matrix.updateFlip(direction);
+    param->componentTransform->setFlip(direction);
     EventManager::getInstance().dispatcher.enqueue<MoverEvent>(MoverEvent{
         .entity = param->entity, .force = Vector(direction * param->componentStatusPlayer->move_force, 0)
     });
@@ -58,9 +58,10 @@ void AnimationSystem::registerAnimation_aux(const entt::entity entity, const std
                                             const Texture::Config& textureConfig, const Clip& clipConfig)
 {
     auto& registry = World::getInstance().registry;
-    if (!FileUtils::directoryExists(basePath))
+    // A directory or a clip, listed from the manifest when there is one
+    if (TextureManager::getInstance().getTextureCount(basePath) == 0)
     {
-        std::cerr << "AnimatorSystem: Animation directory does not exist:" << basePath;
+        std::cerr << "AnimatorSystem: Animation directory or clip does not exist:" << basePath;
         std::cerr << "Current working directory:" << FileUtils::getAbsolutePath(".");
         throw FileNotFoundException("Animation directory does not exist");
     }
@@ -133,7 +134,11 @@ inline void AnimationSystem::updateAnimation(entt::entity entity, Animator& anim
 inline void AnimationSystem::updateDrawableTexture(entt::entity entity, const Animator& anim, Drawable& drawable)
 {
     // Get the current frame index
-    Texture* texture = anim.current->frames.at(anim.currentFrame);
+    const TextureHandle& texture = anim.current->frames.at(anim.currentFrame);
     assert(texture);
-    drawable.texture = texture;
+    if (drawable.texture != texture)
+    {
+        // Patched so the render queue and the visibility grid pick up the new frame
+        World::getInstance().registry.patch<Drawable>(entity, [&texture](Drawable& d) { d.texture = texture; });
+    }
 }
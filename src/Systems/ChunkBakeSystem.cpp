@@ -0,0 +1,203 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "ChunkBakeSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QPainter>
+#include <QtMath>
+
+#include "../Components/Chunk.h"
+#include "../Components/Drawable.h"
+#include "../Components/Tags.h"
+#include "../Components/Transform.h"
+
+ChunkBakeSystem::ChunkBakeSystem()
+{
+    auto& registry = World::getInstance().registry;
+    registry.on_update<Transform>().connect<&ChunkBakeSystem::onTileChanged>(this);
+    registry.on_update<Drawable>().connect<&ChunkBakeSystem::onTileChanged>(this);
+    registry.on_destroy<Transform>().connect<&ChunkBakeSystem::onTileChanged>(this);
+    registry.on_destroy<Drawable>().connect<&ChunkBakeSystem::onTileChanged>(this);
+    registry.on_destroy<TagStaticSprite>().connect<&ChunkBakeSystem::onTileChanged>(this);
+    registry.on_destroy<BakedTile>().connect<&ChunkBakeSystem::onTileDestroyed>(this);
+}
+
+ChunkBakeSystem::~ChunkBakeSystem()
+{
+    auto& registry = World::getInstance().registry;
+    registry.on_update<Transform>().disconnect(this);
+    registry.on_update<Drawable>().disconnect(this);
+    registry.on_destroy<Transform>().disconnect(this);
+    registry.on_destroy<Drawable>().disconnect(this);
+    registry.on_destroy<TagStaticSprite>().disconnect(this);
+    registry.on_destroy<BakedTile>().disconnect(this);
+}
+
+size_t ChunkBakeSystem::ChunkKeyHash::operator()(const ChunkKey& key) const
+{
+    size_t hash = std::hash<int32_t>{}(key.x);
+    hash = hash * 31 + std::hash<int32_t>{}(key.y);
+    hash = hash * 31 + std::hash<uint32_t>{}(key.layer);
+    return hash * 31 + std::hash<float>{}(key.z);
+}
+
+void ChunkBakeSystem::update()
+{
+    auto& registry = World::getInstance().registry;
+
+    // New static sprites, and the ones a change took out of their chunk
+    pending.clear();
+    for (const auto entity : registry.view<TagStaticSprite, Drawable, Transform>(entt::exclude<BakedTile>))
+    {
+        pending.push_back(entity);
+    }
+    for (const auto entity : pending)
+    {
+        assign(registry, entity);
+    }
+
+    pending.clear();
+    for (auto [entity, chunk] : registry.view<BakedChunk>().each())
+    {
+        if (chunk.dirty)
+        {
+            pending.push_back(entity);
+        }
+    }
+    for (const auto entity : pending)
+    {
+        bake(registry, entity);
+    }
+}
+
+void ChunkBakeSystem::assign(entt::registry& registry, const entt::entity tile)
+{
+    const auto& transform = registry.get<Transform>(tile);
+    const auto& drawable = registry.get<Drawable>(tile);
+    // Coloured tiles are drawn on their own, the colour may be animated
+    if (!drawable.texture || drawable.texture.pixels()->image.isNull() || drawable.texture->config.scale <= 0 ||
+        !drawable.color.isPlain())
+    {
+        return;
+    }
+    const ChunkKey key{
+        .x = static_cast<int32_t>(std::floor(transform.position.x / chunkSize)),
+        .y = static_cast<int32_t>(std::floor(transform.position.y / chunkSize)),
+        .layer = drawable.layer,
+        .z = transform.z
+    };
+    auto [it, inserted] = chunks.try_emplace(key, entt::null);
+    if (inserted)
+    {
+        it->second = registry.create();
+        registry.emplace<BakedChunk>(it->second);
+    }
+    auto& chunk = registry.get<BakedChunk>(it->second);
+    chunk.tiles.push_back(tile);
+    chunk.dirty = true;
+    registry.emplace<BakedTile>(tile, it->second);
+}
+
+void ChunkBakeSystem::unassign(entt::registry& registry, const entt::entity tile)
+{
+    // onTileDestroyed does the bookkeeping
+    registry.remove<BakedTile>(tile);
+}
+
+void ChunkBakeSystem::onTileChanged(entt::registry& registry, const entt::entity entity)
+{
+    if (registry.all_of<BakedTile>(entity))
+    {
+        // update() puts it back, in whatever chunk it now belongs to
+        unassign(registry, entity);
+    }
+}
+
+void ChunkBakeSystem::onTileDestroyed(entt::registry& registry, const entt::entity entity)
+{
+    const auto chunkEntity = registry.get<BakedTile>(entity).chunk;
+    if (!registry.valid(chunkEntity))
+    {
+        return;
+    }
+    auto& chunk = registry.get<BakedChunk>(chunkEntity);
+    std::erase(chunk.tiles, entity);
+    chunk.dirty = true;
+}
+
+void ChunkBakeSystem::bake(entt::registry& registry, const entt::entity entity)
+{
+    auto& chunk = registry.get<BakedChunk>(entity);
+    chunk.dirty = false;
+    if (chunk.tiles.empty())
+    {
+        std::erase_if(chunks, [entity](const auto& item) { return item.second == entity; });
+        registry.destroy(entity);
+        return;
+    }
+
+    // The image covers every tile whole, tiles overhanging the cell are not clipped
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    float density = 0;
+    for (const auto tile : chunk.tiles)
+    {
+        const auto& drawable = registry.get<Drawable>(tile);
+        const Transform transform = placement(drawable, registry.get<Transform>(tile));
+        const Texture& texture = *drawable.texture.pixels();
+        const float height = texture.config.scale;
+        const float width = height * static_cast<float>(texture.image.width()) / static_cast<float>(texture.image.height());
+        const float extent = 0.5f * std::sqrt(width * width + height * height) * std::abs(transform.scale);
+        minX = std::min(minX, transform.position.x - extent);
+        minY = std::min(minY, transform.position.y - extent);
+        maxX = std::max(maxX, transform.position.x + extent);
+        maxY = std::max(maxY, transform.position.y + extent);
+        // Texels per world unit of the sharpest tile
+        density = std::max(density, static_cast<float>(texture.image.height()) / height);
+    }
+    density = std::min(density, static_cast<float>(maxChunkPixels) / std::max(maxX - minX, maxY - minY));
+
+    QImage image(std::max(1, static_cast<int>(std::ceil((maxX - minX) * density))),
+                 std::max(1, static_cast<int>(std::ceil((maxY - minY) * density))),
+                 QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    for (const auto tile : chunk.tiles)
+    {
+        const auto& drawable = registry.get<Drawable>(tile);
+        const Transform transform = placement(drawable, registry.get<Transform>(tile));
+        const Texture& texture = *drawable.texture.pixels();
+        const QImage& source = texture.image;
+        const float height = texture.config.scale;
+        const float width = height * static_cast<float>(source.width()) / static_cast<float>(source.height());
+        painter.save();
+        // Image rows grow downwards, world y grows upwards
+        painter.translate((transform.position.x - minX) * density, (maxY - transform.position.y) * density);
+        painter.rotate(qRadiansToDegrees(b2Rot_GetAngle(transform.rotation)));
+        painter.scale(transform.scale * width * density / static_cast<float>(source.width()),
+                      std::abs(transform.scale) * height * density / static_cast<float>(source.height()));
+        painter.drawImage(QPointF(-source.width() / 2.0, -source.height() / 2.0), source);
+        painter.restore();
+    }
+    painter.end();
+
+    // Rounding grew the image a little, place it by its actual size
+    const float bakedWidth = static_cast<float>(image.width()) / density;
+    const float bakedHeight = static_cast<float>(image.height()) / density;
+    const auto& first = registry.get<Transform>(chunk.tiles.front());
+    const auto layer = registry.get<Drawable>(chunk.tiles.front()).layer;
+    const Transform placement{
+        .position = {minX + bakedWidth / 2, maxY - bakedHeight / 2},
+        .z = first.z
+    };
+    // The previous texture lives on in the snapshots that still show it
+    chunk.texture = std::make_shared<Texture>(Texture{.image = std::move(image), .config = {.scale = bakedHeight}});
+    registry.emplace_or_replace<Transform>(entity, placement);
+    registry.emplace_or_replace<Drawable>(entity, Drawable{.texture = TextureHandle::unowned(chunk.texture.get()), .layer = layer});
+}
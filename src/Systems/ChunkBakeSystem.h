@@ -0,0 +1,58 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef CHUNKBAKESYSTEM_H
+#define CHUNKBAKESYSTEM_H
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "System.h"
+#include "../Core/World.h"
+
+/*
+    Bakes static sprites (TagStaticSprite) into one image per chunk of the world, drawn as a single sprite.
+    Tiles are grouped by chunk cell, layer and depth, so the baked image keeps the ordering the render queue
+    would have given them. A chunk is re-baked only when one of its tiles changes or goes away.
+*/
+class ChunkBakeSystem final : public System<ChunkBakeSystem>
+{
+public:
+    ChunkBakeSystem();
+    ~ChunkBakeSystem() override;
+
+    void update() override;
+
+private:
+    constexpr static float chunkSize = 8.0f;
+    // Largest side of a chunk image, denser chunks are baked at a lower resolution
+    constexpr static int maxChunkPixels = 2048;
+
+    struct ChunkKey
+    {
+        int32_t x;
+        int32_t y;
+        uint32_t layer;
+        float z;
+
+        bool operator==(const ChunkKey&) const = default;
+    };
+
+    struct ChunkKeyHash
+    {
+        size_t operator()(const ChunkKey& key) const;
+    };
+
+    std::unordered_map<ChunkKey, entt::entity, ChunkKeyHash> chunks;
+    std::vector<entt::entity> pending;
+
+    void assign(entt::registry& registry, entt::entity tile);
+    void unassign(entt::registry& registry, entt::entity tile);
+    void bake(entt::registry& registry, entt::entity chunk);
+    void onTileChanged(entt::registry& registry, entt::entity entity);
+    void onTileDestroyed(entt::registry& registry, entt::entity entity);
+};
+
+
+#endif //CHUNKBAKESYSTEM_H
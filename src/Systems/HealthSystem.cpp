@@ -3,10 +3,14 @@
 //
 
 #include "HealthSystem.h"
+
+#include <algorithm>
+
 #include "entt/entt.hpp"
 
-#include "../Components/Types.h"
+#include "../Components/Drawable.h"
 #include "../Components/Status.h"
+#include "../Components/Types.h"
 #include "../Events/ProjectileHitEvent.h"
 #include "../Managers/EventManager.h"
 
@@ -23,14 +27,40 @@ HealthSystem::~HealthSystem()
 void HealthSystem::onHit(const ProjectileHitEvent& event)
 {
     auto& registry = World::getInstance().registry;
-    assert((registry.all_of<TypePlayer,StatusPlayer>(event.target)));
-    assert((registry.all_of<TypeProjectile,StatusProjectile>(event.projectile)));
-    // registry.patch<>()
+    // The target may be gone by the time the queued hit is delivered
+    if (const auto drawable = registry.try_get<Drawable>(event.target))
+    {
+        if (drawable->color.flash == 0)
+        {
+            flashing.push_back(event.target);
+        }
+        drawable->color.flash = 255;
+        if (const auto buff = registry.try_get<StatusBuff>(event.target))
+        {
+            buff->active |= StatusBuff::hurt;
+        }
+    }
 }
 
 void HealthSystem::update()
 {
     auto& registry = World::getInstance().registry;
+    // Fade the flashes of earlier hits before the new ones light up
+    std::erase_if(flashing, [&registry](const entt::entity entity)
+    {
+        if (const auto drawable = registry.try_get<Drawable>(entity))
+        {
+            drawable->color.flash = static_cast<uint8_t>(std::max(0, drawable->color.flash - flashFade));
+            if (drawable->color.flash != 0)
+            {
+                return false;
+            }
+        }
+        if (const auto buff = registry.try_get<StatusBuff>(entity))
+        {
+            buff->active &= ~StatusBuff::hurt;
+        }
+        return true;
+    });
     EventManager::getInstance().dispatcher.update<ProjectileHitEvent>();
-
 }
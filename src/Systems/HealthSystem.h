@@ -4,18 +4,31 @@
 
 #ifndef HEALTHSYSTEM_H
 #define HEALTHSYSTEM_H
+#include <cstdint>
+#include <vector>
+
 #include "System.h"
 #include "../Core/World.h"
 #include "../Events/ProjectileHitEvent.h"
 
 
-class HealthSystem final : System<HealthSystem>
+// Flashes the target of a projectile hit white (SpriteColor::flash) and fades it back, the target shows the hurt
+// buff (StatusBuff::hurt) meanwhile. Health is left alone
+class HealthSystem final : public System<HealthSystem>
 {
+public:
     HealthSystem();
     ~HealthSystem() override;
 
-    void onHit(const ProjectileHitEvent& event);
     void update() override;
+
+private:
+    // Flash taken off per tick, a hit fades out in about a quarter of a second
+    constexpr static uint8_t flashFade = 16;
+    // Entities whose flash is fading
+    std::vector<entt::entity> flashing;
+
+    void onHit(const ProjectileHitEvent& event);
 };
 
 
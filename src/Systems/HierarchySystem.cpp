@@ -0,0 +1,166 @@
+//
+// Created by root on 7/9/25.
+//
+
+#include "HierarchySystem.h"
+
+#include "../Components/Transform.h"
+
+HierarchySystem::HierarchySystem()
+{
+    World::getInstance().registry.on_destroy<Hierarchy>().connect<&HierarchySystem::onDestroy>(this);
+}
+
+HierarchySystem::~HierarchySystem()
+{
+    World::getInstance().registry.on_destroy<Hierarchy>().disconnect<&HierarchySystem::onDestroy>(this);
+}
+
+void HierarchySystem::attach(const entt::entity child, const entt::entity parent, const Transform& local)
+{
+    auto& registry = World::getInstance().registry;
+    assert(registry.valid(child) && registry.valid(parent) && child != parent);
+    auto& parentNode = registry.get_or_emplace<Hierarchy>(parent);
+    auto& childNode = registry.get_or_emplace<Hierarchy>(child);
+    if (childNode.parent != entt::null)
+    {
+        unlink(child, childNode);
+    }
+    registry.get_or_emplace<Transform>(child);
+
+    childNode.parent = parent;
+    childNode.previousSibling = entt::null;
+    childNode.nextSibling = parentNode.firstChild;
+    if (parentNode.firstChild != entt::null)
+    {
+        registry.get<Hierarchy>(parentNode.firstChild).previousSibling = child;
+    }
+    parentNode.firstChild = child;
+    childNode.local = local;
+    childNode.dirty = true;
+    setDepth(child, parentNode.depth + 1);
+}
+
+void HierarchySystem::detach(const entt::entity child)
+{
+    auto& registry = World::getInstance().registry;
+    auto& node = registry.get<Hierarchy>(child);
+    if (node.parent == entt::null)
+    {
+        return;
+    }
+    unlink(child, node);
+    node.dirty = true;
+    setDepth(child, 0);
+}
+
+void HierarchySystem::markDirty(const entt::entity entity)
+{
+    World::getInstance().registry.get<Hierarchy>(entity).dirty = true;
+}
+
+void HierarchySystem::unlink(const entt::entity child, Hierarchy& node)
+{
+    auto& registry = World::getInstance().registry;
+    if (node.previousSibling != entt::null)
+    {
+        registry.get<Hierarchy>(node.previousSibling).nextSibling = node.nextSibling;
+    }
+    else if (node.parent != entt::null)
+    {
+        registry.get<Hierarchy>(node.parent).firstChild = node.nextSibling;
+    }
+    if (node.nextSibling != entt::null)
+    {
+        registry.get<Hierarchy>(node.nextSibling).previousSibling = node.previousSibling;
+    }
+    node.parent = entt::null;
+    node.nextSibling = entt::null;
+    node.previousSibling = entt::null;
+}
+
+void HierarchySystem::setDepth(const entt::entity entity, const uint32_t depth)
+{
+    auto& registry = World::getInstance().registry;
+    std::vector<std::pair<entt::entity, uint32_t>> pending{{entity, depth}};
+    while (!pending.empty())
+    {
+        const auto [current, currentDepth] = pending.back();
+        pending.pop_back();
+        auto& node = registry.get<Hierarchy>(current);
+        node.depth = currentDepth;
+        for (auto child = node.firstChild; child != entt::null; child = registry.get<Hierarchy>(child).nextSibling)
+        {
+            pending.emplace_back(child, currentDepth + 1);
+        }
+    }
+    topologyChanged = true;
+}
+
+void HierarchySystem::onDestroy(entt::registry& registry, const entt::entity entity)
+{
+    auto& node = registry.get<Hierarchy>(entity);
+    unlink(entity, node);
+    // Children of a destroyed holder stay where they are as roots
+    for (auto child = node.firstChild; child != entt::null;)
+    {
+        auto& childNode = registry.get<Hierarchy>(child);
+        const auto next = childNode.nextSibling;
+        childNode.parent = entt::null;
+        childNode.previousSibling = entt::null;
+        childNode.nextSibling = entt::null;
+        childNode.dirty = true;
+        setDepth(child, 0);
+        child = next;
+    }
+    node.firstChild = entt::null;
+}
+
+void HierarchySystem::update()
+{
+    auto& registry = World::getInstance().registry;
+    if (topologyChanged)
+    {
+        // Only links changed, so most frames skip the sort and the sweep below stays a linear walk
+        registry.sort<Hierarchy>([](const Hierarchy& lhs, const Hierarchy& rhs)
+        {
+            return lhs.depth < rhs.depth;
+        });
+        topologyChanged = false;
+    }
+
+    ++tick;
+    auto& nodes = registry.storage<Hierarchy>();
+    auto& transforms = registry.storage<Transform>();
+    for (auto [entity, node] : registry.view<Hierarchy>().each())
+    {
+        if (node.parent == entt::null)
+        {
+            // Roots are moved by their owner (physics, scripts), only notice when they did
+            if (node.firstChild == entt::null || !transforms.contains(entity))
+            {
+                node.dirty = false;
+                continue;
+            }
+            const Transform& world = transforms.get(entity);
+            if (node.dirty || !(world == node.world))
+            {
+                node.world = world;
+                node.changed = tick;
+            }
+        }
+        else
+        {
+            // The parent was visited earlier in this sweep thanks to the depth order
+            const Hierarchy& parentNode = nodes.get(node.parent);
+            if (node.dirty || parentNode.changed == tick)
+            {
+                node.world = parentNode.world * node.local;
+                node.changed = tick;
+                // Patched rather than assigned so the visibility grid hears about the move
+                registry.patch<Transform>(entity, [&node](Transform& transform) { transform = node.world; });
+            }
+        }
+        node.dirty = false;
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef HIERARCHYSYSTEM_H
+#define HIERARCHYSYSTEM_H
+#include "System.h"
+#include "../Core/World.h"
+#include "../Components/Hierarchy.h"
+#include "../Components/Transform.h"
+
+
+// Keeps attached entities (weapons, effects, pets...) following the Transform of their holder
+class HierarchySystem final : public System<HierarchySystem>
+{
+public:
+    HierarchySystem();
+    ~HierarchySystem() override;
+
+    // Attach child under parent, placed at local relative to it, the child is detached first if needed
+    void attach(entt::entity child, entt::entity parent, const Transform& local = Transform());
+    // Make child a root again, it keeps its current world transform
+    void detach(entt::entity child);
+    // Force the subtree of entity to be recomputed on the next update, e.g. after editing Hierarchy::local
+    void markDirty(entt::entity entity);
+
+    void update() override;
+
+private:
+    uint32_t tick = 0;
+    bool topologyChanged = false;
+
+    void setDepth(entt::entity entity, uint32_t depth);
+    void unlink(entt::entity child, Hierarchy& node);
+    void onDestroy(entt::registry& registry, entt::entity entity);
+};
+
+
+#endif //HIERARCHYSYSTEM_H
@@ -105,8 +105,7 @@ void PhysicsSystem::syncData()
     view.each([](const entt::entity& entity, const Body& body, Transform& transform)
     {
         auto& bodyId = body.bodyID;
-        transform.matrix.updateTransform(b2Body_GetTransform(bodyId));
-        // transform.matrix = Matrix(b2Body_GetTransform(bodyId));
+        transform.updateTransform(b2Body_GetTransform(bodyId));
     });
 }
 
@@ -136,7 +135,7 @@ void PhysicsSystem::updateGroundDetectors()
     view.each([&](const entt::entity entity, const Body& body, const Transform& transform, GroundDetector& detector)
     {
         detector.got = false;
-        const b2Circle circle = {b2TransformPoint(transform.matrix, detector.offset), 0.1f};
+        const b2Circle circle = {b2TransformPoint(transform, detector.offset), 0.1f};
         const b2ShapeProxy proxy = b2MakeProxy(&circle.center, 1, circle.radius);
         const b2QueryFilter filter = {.categoryBits = GroundDetector::category(), .maskBits = GroundDetector::mask()};
         b2World_OverlapShape(worldId, &proxy, filter, &PhysicsSystem::updateGroundDetectors_aux, &detector);
@@ -220,8 +219,8 @@ void PhysicsSystem::createBody() const
             bodyDef.isBullet = movementDesc->isBullet;
             bodyDef.linearDamping = movementDesc->linearDamping;
             bodyDef.motionLocks.angularZ = movementDesc->rotationLocked;
-            bodyDef.position = transform.matrix.getPosition();
-            bodyDef.rotation = transform.matrix.getRotation();
+            bodyDef.position = transform.position;
+            bodyDef.rotation = transform.rotation;
             bodyDef.userData = EntityWrapper(entity);
             bodyDef.gravityScale=movementDesc->gravityScale;
             shapeDef.filter = {
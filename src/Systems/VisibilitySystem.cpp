@@ -0,0 +1,239 @@
+//
+// Created by root on 7/10/25.
+//
+
+#include "VisibilitySystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+#include "../Components/Body.h"
+#include "../Components/Chunk.h"
+#include "../Components/Drawable.h"
+#include "../Components/Transform.h"
+#include "../Utils/Wrapper.h"
+
+VisibilitySystem::VisibilitySystem()
+{
+    auto& registry = World::getInstance().registry;
+    registry.on_construct<Drawable>().connect<&VisibilitySystem::onDrawableChanged>(this);
+    registry.on_update<Drawable>().connect<&VisibilitySystem::onDrawableChanged>(this);
+    registry.on_construct<Transform>().connect<&VisibilitySystem::onDrawableChanged>(this);
+    registry.on_update<Transform>().connect<&VisibilitySystem::onDrawableChanged>(this);
+    registry.on_destroy<Drawable>().connect<&VisibilitySystem::remove>(this);
+    registry.on_destroy<Transform>().connect<&VisibilitySystem::remove>(this);
+    registry.on_construct<Body>().connect<&VisibilitySystem::onBodyCreated>(this);
+    registry.on_destroy<Body>().connect<&VisibilitySystem::onBodyDestroyed>(this);
+
+    // Drawables created before the first query
+    for (const auto entity : registry.view<const Drawable, const Transform>(entt::exclude<Body>))
+    {
+        insert(registry, entity);
+    }
+}
+
+VisibilitySystem::~VisibilitySystem()
+{
+    auto& registry = World::getInstance().registry;
+    registry.on_construct<Drawable>().disconnect(this);
+    registry.on_update<Drawable>().disconnect(this);
+    registry.on_construct<Transform>().disconnect(this);
+    registry.on_update<Transform>().disconnect(this);
+    registry.on_destroy<Drawable>().disconnect(this);
+    registry.on_destroy<Transform>().disconnect(this);
+    registry.on_construct<Body>().disconnect(this);
+    registry.on_destroy<Body>().disconnect(this);
+}
+
+uint64_t VisibilitySystem::cellKey(const int32_t x, const int32_t y)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+}
+
+b2AABB VisibilitySystem::bounds(const entt::registry& registry, const entt::entity entity)
+{
+    const auto& transform = registry.get<Transform>(entity);
+    float width = 1;
+    float height = 1;
+    const auto& drawable = registry.get<Drawable>(entity);
+    // Not the image, it is empty while the texture is packed
+    if (drawable.texture && !drawable.texture.size().isEmpty())
+    {
+        // Texture::Config::scale is the height of the sprite in world units. The whole canvas of a trimmed
+        // texture, so the box does not shrink and grow with the opaque part of each animation frame
+        const QSizeF size = drawable.texture.size();
+        width = static_cast<float>(size.width());
+        height = static_cast<float>(size.height());
+    }
+    // Half diagonal, so the box holds the sprite whatever its rotation
+    const float extent = 0.5f * std::sqrt(width * width + height * height) * std::abs(transform.scale);
+    return b2AABB{
+        .lowerBound = {transform.position.x - extent, transform.position.y - extent},
+        .upperBound = {transform.position.x + extent, transform.position.y + extent}
+    };
+}
+
+bool VisibilitySystem::markVisited(const entt::entity entity)
+{
+    const auto index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= stamps.size())
+    {
+        stamps.resize(index + 1, 0);
+    }
+    if (stamps[index] == frame)
+    {
+        return false;
+    }
+    stamps[index] = frame;
+    return true;
+}
+
+void VisibilitySystem::insert(entt::registry& registry, const entt::entity entity)
+{
+    const b2AABB box = bounds(registry, entity);
+    const GridProxy proxy = {
+        .minX = static_cast<int32_t>(std::floor(box.lowerBound.x / cellSize)),
+        .minY = static_cast<int32_t>(std::floor(box.lowerBound.y / cellSize)),
+        .maxX = static_cast<int32_t>(std::floor(box.upperBound.x / cellSize)),
+        .maxY = static_cast<int32_t>(std::floor(box.upperBound.y / cellSize)),
+    };
+    for (int32_t x = proxy.minX; x <= proxy.maxX; x++)
+    {
+        for (int32_t y = proxy.minY; y <= proxy.maxY; y++)
+        {
+            cells[cellKey(x, y)].push_back(entity);
+        }
+    }
+    proxies[entity] = proxy;
+}
+
+void VisibilitySystem::remove(entt::registry&, const entt::entity entity)
+{
+    const auto it = proxies.find(entity);
+    if (it == proxies.end())
+    {
+        return;
+    }
+    const GridProxy& proxy = it->second;
+    for (int32_t x = proxy.minX; x <= proxy.maxX; x++)
+    {
+        for (int32_t y = proxy.minY; y <= proxy.maxY; y++)
+        {
+            const auto cell = cells.find(cellKey(x, y));
+            assert(cell != cells.end());
+            auto& entities = cell->second;
+            const auto position = std::find(entities.begin(), entities.end(), entity);
+            assert(position != entities.end());
+            *position = entities.back();
+            entities.pop_back();
+            if (entities.empty())
+            {
+                cells.erase(cell);
+            }
+        }
+    }
+    proxies.erase(it);
+}
+
+void VisibilitySystem::onDrawableChanged(entt::registry& registry, const entt::entity entity)
+{
+    if (!registry.all_of<Drawable, Transform>(entity) || registry.all_of<Body>(entity))
+    {
+        return;
+    }
+    const auto it = proxies.find(entity);
+    if (it != proxies.end())
+    {
+        // Most updates stay in the same cells, skip the relink then
+        const b2AABB box = bounds(registry, entity);
+        const GridProxy& proxy = it->second;
+        if (static_cast<int32_t>(std::floor(box.lowerBound.x / cellSize)) == proxy.minX &&
+            static_cast<int32_t>(std::floor(box.lowerBound.y / cellSize)) == proxy.minY &&
+            static_cast<int32_t>(std::floor(box.upperBound.x / cellSize)) == proxy.maxX &&
+            static_cast<int32_t>(std::floor(box.upperBound.y / cellSize)) == proxy.maxY)
+        {
+            return;
+        }
+        remove(registry, entity);
+    }
+    insert(registry, entity);
+}
+
+void VisibilitySystem::onBodyCreated(entt::registry& registry, const entt::entity entity)
+{
+    // From now on the broadphase tracks it
+    remove(registry, entity);
+}
+
+void VisibilitySystem::onBodyDestroyed(entt::registry& registry, const entt::entity entity)
+{
+    if (registry.all_of<Drawable, Transform>(entity) && !proxies.contains(entity))
+    {
+        insert(registry, entity);
+    }
+}
+
+namespace
+{
+    struct PhysicsQuery
+    {
+        VisibilitySystem* system;
+        const entt::registry* registry;
+        std::vector<entt::entity>* visible;
+    };
+}
+
+bool VisibilitySystem::collectPhysics(const b2ShapeId shapeId, void* context)
+{
+    const auto query = static_cast<PhysicsQuery*>(context);
+    const entt::entity entity = EntityWrapper(b2Shape_GetUserData(shapeId));
+    if (query->registry->valid(entity) && query->registry->all_of<Drawable>(entity) &&
+        !query->registry->all_of<BakedTile>(entity) && query->system->markVisited(entity))
+    {
+        query->visible->push_back(entity);
+    }
+    return true;
+}
+
+void VisibilitySystem::collectVisible(const b2AABB& area, std::vector<entt::entity>& visible)
+{
+    auto& registry = World::getInstance().registry;
+    ++frame;
+
+    if (!registry.storage<Body>().empty())
+    {
+        const b2AABB widened = {
+            .lowerBound = {area.lowerBound.x - physicsMargin, area.lowerBound.y - physicsMargin},
+            .upperBound = {area.upperBound.x + physicsMargin, area.upperBound.y + physicsMargin}
+        };
+        PhysicsQuery query{.system = this, .registry = &registry, .visible = &visible};
+        b2World_OverlapAABB(PhysicsSystem::getInstance().worldId, widened, b2DefaultQueryFilter(),
+                            &VisibilitySystem::collectPhysics, &query);
+    }
+
+    const auto minX = static_cast<int32_t>(std::floor(area.lowerBound.x / cellSize));
+    const auto minY = static_cast<int32_t>(std::floor(area.lowerBound.y / cellSize));
+    const auto maxX = static_cast<int32_t>(std::floor(area.upperBound.x / cellSize));
+    const auto maxY = static_cast<int32_t>(std::floor(area.upperBound.y / cellSize));
+    for (int32_t x = minX; x <= maxX; x++)
+    {
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            const auto cell = cells.find(cellKey(x, y));
+            if (cell == cells.end())
+            {
+                continue;
+            }
+            for (const auto entity : cell->second)
+            {
+                // Drawn as part of their chunk
+                if (!registry.all_of<BakedTile>(entity) && markVisited(entity))
+                {
+                    visible.push_back(entity);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef VISIBILITYSYSTEM_H
+#define VISIBILITYSYSTEM_H
+#include <unordered_map>
+#include <vector>
+
+#include "System.h"
+#include "../Core/World.h"
+#include "box2d/id.h"
+#include "box2d/math_functions.h"
+
+/*
+    Finds the drawables overlapping the camera rectangle.
+    Drawables with a Body are found through the box2d broadphase, every other drawable is kept in a uniform grid
+    that is updated from the registry signals (construct, update and destroy of Transform, Drawable and Body),
+    so neither path walks the whole world.
+*/
+class VisibilitySystem final : public System<VisibilitySystem>
+{
+public:
+    VisibilitySystem();
+    ~VisibilitySystem() override;
+
+    // Appends every drawable entity that may overlap area, each at most once
+    void collectVisible(const b2AABB& area, std::vector<entt::entity>& visible);
+
+private:
+    // Cells of the grid a non-physics drawable is registered in
+    struct GridProxy
+    {
+        int32_t minX, minY, maxX, maxY;
+    };
+
+    constexpr static float cellSize = 8.0f;
+    // Sprites are usually larger than their collision shape, widen the broadphase query by this much
+    constexpr static float physicsMargin = 2.0f;
+
+    std::unordered_map<uint64_t, std::vector<entt::entity>> cells;
+    std::unordered_map<entt::entity, GridProxy> proxies;
+    // Frame stamp per entity index, dedupes entities registered in several cells
+    std::vector<uint32_t> stamps;
+    uint32_t frame = 0;
+
+    static uint64_t cellKey(int32_t x, int32_t y);
+    static b2AABB bounds(const entt::registry& registry, entt::entity entity);
+    bool markVisited(entt::entity entity);
+
+    void insert(entt::registry& registry, entt::entity entity);
+    void remove(entt::registry& registry, entt::entity entity);
+    void onDrawableChanged(entt::registry& registry, entt::entity entity);
+    void onBodyCreated(entt::registry& registry, entt::entity entity);
+    void onBodyDestroyed(entt::registry& registry, entt::entity entity);
+    static bool collectPhysics(b2ShapeId shapeId, void* context);
+};
+
+
+#endif //VISIBILITYSYSTEM_H
@@ -14,4 +14,9 @@ struct FileNotFoundException final : std::runtime_error
 {
     using std::runtime_error::runtime_error;
 };
+
+struct StreamFormatException final : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
 #endif //ERRORS_H
@@ -10,10 +10,10 @@
 #include "box2d/math_functions.h"
 
 
+// Render side matrix, built from a Transform at submission
 class Matrix : public QMatrix4x4
 {
 public:
-    float flip = 1;
     // 构造函数
     Matrix()
     {
@@ -23,44 +23,6 @@ public:
     {
     }
 
-    explicit Matrix(const b2Transform& transform): QMatrix4x4{
-        transform.q.c, -transform.q.s, 0, transform.p.x,
-        transform.q.s, transform.q.c, 0, transform.p.y,
-        0, 0, 1, 0,
-        0, 0, 0, 1
-    }
-    {
-    }
-
-    void updateFlip(const float flip)
-    {
-        this->flip = flip;
-    }
-
-    void updateTransform(const b2Transform& transform)
-    {
-        (*this)(0, 0) = flip * transform.q.c;
-        (*this)(0, 1) = transform.q.s;
-        (*this)(0, 2) = 0;
-        (*this)(0, 3) = transform.p.x;
-
-        (*this)(1, 0) = -flip * transform.q.s;
-        (*this)(1, 1) = transform.q.c;
-        (*this)(1, 2) = 0;
-        (*this)(1, 3) = transform.p.y;
-
-        (*this)(2, 0) = 0;
-        (*this)(2, 1) = 0;
-        (*this)(2, 2) = 1;
-        (*this)(2, 3) = 0;
-
-        (*this)(3, 0) = 0;
-        (*this)(3, 1) = 0;
-        (*this)(3, 2) = 0;
-        (*this)(3, 3) = 1;
-    }
-
-
     // 获取位置
     Vector getPosition() const
     {
@@ -73,16 +35,6 @@ public:
         return Vector((*this)(1, 1), (*this)(0, 1));
     }
 
-    operator const b2Transform() const
-    {
-        b2Transform result;
-        result.p.x = (*this)(0, 3);
-        result.p.y = (*this)(1, 3);
-        result.q.c = (*this)(1, 1);
-        result.q.s = (*this)(0, 1);
-        return result;
-    }
-
     static Matrix fromTranslation(const Vector translate)
     {
         Matrix result;
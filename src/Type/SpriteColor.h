@@ -0,0 +1,30 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef SPRITECOLOR_H
+#define SPRITECOLOR_H
+#include <cstdint>
+
+/*
+    Per-draw colour modulation, applied in this order to each texel (straight alpha):
+        tint      the colour of the texel is pulled towards the rgb of tint by its alpha, the texel alpha is kept
+                  (dark or highlighted icons, team colours on a greyscale sprite)
+        flash     then pulled towards white by flash / 255 (hit flashes)
+        multiply  then multiplied by multiply, alpha included (fades, darkening)
+    Colours are 0xAARRGGBB like QRgb. The default leaves the texture untouched.
+*/
+struct SpriteColor {
+    uint32_t multiply = 0xFFFFFFFF;
+    uint32_t tint = 0;
+    uint8_t flash = 0;
+
+    bool isPlain() const
+    {
+        return multiply == 0xFFFFFFFF && (tint >> 24) == 0 && flash == 0;
+    }
+
+    bool operator==(const SpriteColor&) const = default;
+};
+
+#endif //SPRITECOLOR_H
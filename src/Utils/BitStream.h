@@ -0,0 +1,176 @@
+//
+// Created by root on 7/9/25.
+//
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Little-endian bit packer, bits are appended from the lowest bit of each byte
+class BitWriter
+{
+    std::vector<uint8_t> bytes;
+    uint64_t scratch = 0;
+    int scratchBits = 0;
+
+public:
+    void writeBits(uint64_t value, const int count)
+    {
+        assert(count >= 0 && count <= 32);
+        if (count == 0)
+        {
+            return;
+        }
+        value &= (uint64_t{1} << count) - 1;
+        scratch |= value << scratchBits;
+        scratchBits += count;
+        while (scratchBits >= 8)
+        {
+            bytes.push_back(static_cast<uint8_t>(scratch));
+            scratch >>= 8;
+            scratchBits -= 8;
+        }
+    }
+
+    void writeBool(const bool value)
+    {
+        writeBits(value ? 1 : 0, 1);
+    }
+
+    // 2 bit width class followed by 4, 8, 16 or 32 payload bits
+    void writeVarUInt(const uint32_t value)
+    {
+        if (value < (1u << 4))
+        {
+            writeBits(0, 2);
+            writeBits(value, 4);
+        }
+        else if (value < (1u << 8))
+        {
+            writeBits(1, 2);
+            writeBits(value, 8);
+        }
+        else if (value < (1u << 16))
+        {
+            writeBits(2, 2);
+            writeBits(value, 16);
+        }
+        else
+        {
+            writeBits(3, 2);
+            writeBits(value, 32);
+        }
+    }
+
+    void writeVarInt(const int32_t value)
+    {
+        // zigzag so small negative deltas stay small
+        writeVarUInt((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    void writeFloat(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeBits(bits, 32);
+    }
+
+    // Pads the last byte and returns the packed buffer
+    const std::vector<uint8_t>& finish()
+    {
+        if (scratchBits > 0)
+        {
+            bytes.push_back(static_cast<uint8_t>(scratch));
+            scratch = 0;
+            scratchBits = 0;
+        }
+        return bytes;
+    }
+
+    void clear()
+    {
+        bytes.clear();
+        scratch = 0;
+        scratchBits = 0;
+    }
+};
+
+class BitReader
+{
+    const uint8_t* data;
+    size_t size;
+    size_t bytePos = 0;
+    uint64_t scratch = 0;
+    int scratchBits = 0;
+    bool overrun = false;
+
+public:
+    BitReader(const uint8_t* data, const size_t size): data(data), size(size)
+    {
+    }
+
+    uint32_t readBits(const int count)
+    {
+        assert(count >= 0 && count <= 32);
+        while (scratchBits < count)
+        {
+            uint64_t next = 0;
+            if (bytePos < size)
+            {
+                next = data[bytePos++];
+            }
+            else
+            {
+                overrun = true;
+            }
+            scratch |= next << scratchBits;
+            scratchBits += 8;
+        }
+        const uint32_t value = static_cast<uint32_t>(scratch & ((uint64_t{1} << count) - 1));
+        scratch >>= count;
+        scratchBits -= count;
+        return value;
+    }
+
+    bool readBool()
+    {
+        return readBits(1) != 0;
+    }
+
+    uint32_t readVarUInt()
+    {
+        constexpr int widths[] = {4, 8, 16, 32};
+        return readBits(widths[readBits(2)]);
+    }
+
+    int32_t readVarInt()
+    {
+        const uint32_t zigzag = readVarUInt();
+        return static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    }
+
+    float readFloat()
+    {
+        const uint32_t bits = readBits(32);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Bits not read yet, to check a length against before allocating for it
+    size_t bitsLeft() const
+    {
+        return overrun ? 0 : (size - bytePos) * 8 + scratchBits;
+    }
+
+    // True once a read went past the end of the buffer
+    bool failed() const
+    {
+        return overrun;
+    }
+};
+
+#endif //BITSTREAM_H
@@ -10,7 +10,7 @@
 
 
 inline std::ostream &operator <<(std::ostream &os, const entt::entity &entity) {
-    return os << static_cast<std::uintptr_t>(entity);
+    return os << entt::to_integral(entity);
 }
 
 template<typename T>
@@ -7,7 +7,13 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace FileUtils {
     // Check if a directory exists
@@ -24,6 +30,76 @@ namespace FileUtils {
     inline std::string getAbsolutePath(const std::string& path) {
         return QFileInfo(QString::fromStdString(path)).absoluteFilePath().toStdString();
     }
+
+    // Clip a file belongs to and its frame in it, taken from the name: dog_walk_3.png is frame 3 of "dog_walk",
+    // 12.png frame 12 of "". A name not ending in a number is a clip of its own with frame -1
+    struct ClipFrame {
+        std::string clip;
+        long long frame = -1;
+    };
+
+    inline ClipFrame clipFrame(const std::string& path) {
+        const size_t slash = path.find_last_of("/\\");
+        std::string stem = slash == std::string::npos ? path : path.substr(slash + 1);
+        const size_t dot = stem.find_last_of('.');
+        if (dot != std::string::npos && dot > 0) {
+            stem.resize(dot);
+        }
+        size_t digits = stem.size();
+        while (digits > 0 && stem[digits - 1] >= '0' && stem[digits - 1] <= '9') {
+            digits--;
+        }
+        // More digits than fit a frame number, treat the name as a clip of its own
+        if (digits == stem.size() || stem.size() - digits > 18) {
+            return {stem, -1};
+        }
+        ClipFrame result{stem.substr(0, digits), std::stoll(stem.substr(digits))};
+        while (!result.clip.empty() && (result.clip.back() == '_' || result.clip.back() == '-' ||
+                                        result.clip.back() == ' ' || result.clip.back() == '.')) {
+            result.clip.pop_back();
+        }
+        return result;
+    }
+
+    // Image files (png, jpg) directly inside a directory, in natural order.
+    // Shared by TextureManager and the asset cooker so both see frames in the same order
+    inline std::vector<std::string> listImages(const std::string& directory) {
+        std::vector<std::string> filePaths;
+
+        namespace fs = std::filesystem;
+        fs::path dirPath(directory);
+
+        if (!fs::exists(dirPath)) {
+            std::cerr << "TextureManager: Directory does not exist: " << directory << std::endl;
+            return filePaths;
+        }
+
+        // Get all files with supported extensions
+        for (const auto& entry : fs::directory_iterator(dirPath)) {
+            if (entry.is_regular_file()) {
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") {
+                    filePaths.push_back(entry.path().string());
+                }
+            }
+        }
+
+        // Natural order: grouped by clip, frames by number. Keys are computed once, not per comparison
+        std::vector<std::pair<ClipFrame, std::string>> keyed;
+        keyed.reserve(filePaths.size());
+        for (auto& path : filePaths) {
+            keyed.emplace_back(clipFrame(path), std::move(path));
+        }
+        std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.first.clip, a.first.frame, a.second) < std::tie(b.first.clip, b.first.frame, b.second);
+        });
+        for (size_t i = 0; i < keyed.size(); i++) {
+            filePaths[i] = std::move(keyed[i].second);
+        }
+
+        return filePaths;
+    }
 }
 
 #endif //FILEUTILS_H
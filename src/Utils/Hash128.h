@@ -0,0 +1,126 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef HASH128_H
+#define HASH128_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 128 bit content hash, MurmurHash3 x64_128 (the seed widened to 64 bits). Fast and well mixed, not for security
+struct Hash128
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    // The default value, hashes never come out as it in practice
+    bool isNull() const
+    {
+        return low == 0 && high == 0;
+    }
+
+    bool operator==(const Hash128& other) const
+    {
+        return low == other.low && high == other.high;
+    }
+
+    // For unordered containers, the low half is as good as any
+    struct Hasher
+    {
+        size_t operator()(const Hash128& hash) const
+        {
+            return static_cast<size_t>(hash.low);
+        }
+    };
+
+    static Hash128 of(const void* data, const size_t size, const uint64_t seed = 0)
+    {
+        constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+        constexpr uint64_t c2 = 0x4cf5ad432745937full;
+        const auto bytes = static_cast<const uint8_t*>(data);
+        uint64_t h1 = seed;
+        uint64_t h2 = seed;
+
+        const size_t blocks = size / 16;
+        for (size_t i = 0; i < blocks; i++)
+        {
+            uint64_t k1;
+            uint64_t k2;
+            std::memcpy(&k1, bytes + i * 16, 8);
+            std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+            k1 *= c1;
+            k1 = rotl(k1, 31);
+            k1 *= c2;
+            h1 ^= k1;
+            h1 = rotl(h1, 27);
+            h1 += h2;
+            h1 = h1 * 5 + 0x52dce729;
+
+            k2 *= c2;
+            k2 = rotl(k2, 33);
+            k2 *= c1;
+            h2 ^= k2;
+            h2 = rotl(h2, 31);
+            h2 += h1;
+            h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        // Up to 15 bytes left, little endian like the blocks
+        const uint8_t* tail = bytes + blocks * 16;
+        const size_t rest = size & 15;
+        uint64_t k1 = 0;
+        uint64_t k2 = 0;
+        for (size_t i = rest; i > 8; i--)
+        {
+            k2 |= uint64_t{tail[i - 1]} << (i - 9) * 8;
+        }
+        for (size_t i = rest < 8 ? rest : 8; i > 0; i--)
+        {
+            k1 |= uint64_t{tail[i - 1]} << (i - 1) * 8;
+        }
+        if (rest > 8)
+        {
+            k2 *= c2;
+            k2 = rotl(k2, 33);
+            k2 *= c1;
+            h2 ^= k2;
+        }
+        if (rest > 0)
+        {
+            k1 *= c1;
+            k1 = rotl(k1, 31);
+            k1 *= c2;
+            h1 ^= k1;
+        }
+
+        h1 ^= size;
+        h2 ^= size;
+        h1 += h2;
+        h2 += h1;
+        h1 = mix(h1);
+        h2 = mix(h2);
+        h1 += h2;
+        h2 += h1;
+        return Hash128{h1, h2};
+    }
+
+private:
+    static uint64_t rotl(const uint64_t value, const int bits)
+    {
+        return value << bits | value >> (64 - bits);
+    }
+
+    static uint64_t mix(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdull;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ull;
+        k ^= k >> 33;
+        return k;
+    }
+};
+
+#endif //HASH128_H
@@ -0,0 +1,53 @@
+//
+// Created by root on 7/10/25.
+//
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock free hand over of the latest value from one writer thread to one reader thread.
+// The writer fills writeBuffer() and publishes it, the reader picks up the newest published buffer with update().
+// Neither side ever waits: the third buffer sits in the middle, so a slow reader only skips values and a slow
+// writer only makes the reader show the same value again. Buffers are reused, keep their allocations around.
+template<typename T>
+class TripleBuffer {
+public:
+    T &writeBuffer() {
+        return buffers[writeIndex];
+    }
+
+    // Hands the written buffer to the reader and takes the middle one back to write into next
+    void publish() {
+        const uint8_t previous = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Switches to the newest published buffer, false if nothing was published since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+            return false;
+        }
+        const uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T &readBuffer() const {
+        return buffers[readIndex];
+    }
+
+private:
+    constexpr static uint8_t indexMask = 0x3;
+    constexpr static uint8_t freshBit = 0x4;
+
+    std::array<T, 3> buffers{};
+    // Apart so the two threads do not share the cache line they write the most
+    alignas(64) uint8_t writeIndex = 0;
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t readIndex = 2;
+};
+
+#endif //TRIPLEBUFFER_H
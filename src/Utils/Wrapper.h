@@ -5,17 +5,21 @@
 #ifndef WRAPPER_H
 #define WRAPPER_H
 #include <cstdint>
+#include <type_traits>
 
 #include "entt/entity/entity.hpp"
 
+// Stores an integral handle (e.g. a 32 bit entt::entity) directly in the value of a box2d void* user data,
+// the handle only has to fit in a pointer, it is never dereferenced
 template<typename T>
 class Wrapper {
 private:
     T wrapped;
+    typedef std::underlying_type_t<T> Integral;
+    static_assert(sizeof(T) <= sizeof(void *), "handle does not fit in box2d user data");
 
 public:
-    Wrapper(void *userData): wrapped(static_cast<T>(reinterpret_cast<std::uintptr_t>(userData))) {
-        static_assert(sizeof(T) == sizeof(void *));
+    Wrapper(void *userData): wrapped(static_cast<T>(static_cast<Integral>(reinterpret_cast<std::uintptr_t>(userData)))) {
     }
 
     Wrapper(const T &e) : wrapped(e) {
@@ -26,8 +30,7 @@ public:
     }
 
     operator void *() const {
-        static_assert(sizeof(T) == sizeof(void *));
-        return reinterpret_cast<void *>(static_cast<std::uintptr_t>(wrapped));
+        return reinterpret_cast<void *>(static_cast<std::uintptr_t>(static_cast<Integral>(wrapped)));
     }
 };
 
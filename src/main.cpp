@@ -1,6 +1,9 @@
 #include <QApplication>
 // #include <QWindow>
 #include <QBasicTimer>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QStandardPaths>
 
 #include "QRenderer2D.h"
 #include "SpiritBatch.h"
@@ -13,6 +16,8 @@
 #include "Components/Drawable.h"
 #include "Components/PhysicsDesciption.h"
 #include "Components/Transform.h"
+#include "Managers/AssetWatcher.h"
+#include "Managers/TextureManager.h"
 #include "Prefab/PrefabPlayer.h"
 #include "Scripts/PlayerScript.h"
 #include "Systems/PhysicsSystem.h"
@@ -21,10 +26,115 @@ int main(int argc, char* argv[])
 {
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption recordOption("record", "Record the match into <file>.", "file");
+    const QCommandLineOption replayOption("replay", "Replay the match recorded in <file>.", "file");
+    const QCommandLineOption packOption("pack", "Load textures from the asset pack <file> (default assets.pack when present).",
+                                        "file", "assets.pack");
+    const QCommandLineOption captureOption("capture-draws", "Capture the draw calls of rendered frames into <file>.",
+                                           "file");
+    const QCommandLineOption captureRangeOption("capture-range",
+                                                "Frames to capture as <first>:<count> (default 0:300).",
+                                                "range", "0:300");
+    const QCommandLineOption budgetOption("texture-budget",
+                                          "MiB of textures kept resident before unused ones are evicted (default 512).",
+                                          "mib");
+    const QCommandLineOption manifestOption("manifest",
+                                            "List assets from the manifest <file> (default assets.manifest next to the "
+                                            "executable when present).", "file");
+    const QCommandLineOption cacheOption("texture-cache",
+                                         "Keep decoded textures in <dir> between runs, empty to disable.", "dir",
+                                         QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/textures");
+    const QCommandLineOption hotReloadOption("hot-reload", "Reload textures whose files change while the game runs.");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(packOption);
+    parser.addOption(captureOption);
+    parser.addOption(captureRangeOption);
+    parser.addOption(budgetOption);
+    parser.addOption(cacheOption);
+    parser.addOption(manifestOption);
+    parser.addOption(hotReloadOption);
+    parser.process(a);
+
+    // Created before the world, so it is destroyed after every texture handle the world holds
+    auto& textures = TextureManager::getInstance();
+    textures.setDiskCache(parser.value(cacheOption).toStdString());
+    const QString manifest = parser.isSet(manifestOption)
+                                 ? parser.value(manifestOption)
+                                 : QCoreApplication::applicationDirPath() + "/assets.manifest";
+    if (parser.isSet(manifestOption) || QFile::exists(manifest))
+    {
+        textures.openManifest(manifest.toStdString());
+    }
+    const QString pack = parser.value(packOption);
+    if (parser.isSet(packOption) || QFile::exists(pack))
+    {
+        textures.openPack(pack.toStdString());
+    }
+    if (parser.isSet(budgetOption))
+    {
+        bool ok = false;
+        const qulonglong budget = parser.value(budgetOption).toULongLong(&ok);
+        if (!ok)
+        {
+            qWarning() << "Invalid texture budget" << parser.value(budgetOption);
+            return 1;
+        }
+        textures.setBudget(static_cast<size_t>(budget) << 20);
+    }
+    std::unique_ptr<AssetWatcher> watcher;
+    if (parser.isSet(hotReloadOption))
+    {
+        watcher = std::make_unique<AssetWatcher>();
+    }
 
     Scene scene;
     scene.show();
-    scene.startGameLoop();
+    if (parser.isSet(captureOption))
+    {
+        auto file = std::make_unique<QFile>(parser.value(captureOption));
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qWarning() << "Cannot open capture file" << file->fileName();
+            return 1;
+        }
+        const QStringList range = parser.value(captureRangeOption).split(':');
+        const uint32_t first = range.value(0).toUInt();
+        const uint32_t count = range.size() > 1 ? range.value(1).toUInt() : 300;
+        scene.startCapture(std::move(file), first, count);
+    }
+    if (parser.isSet(replayOption))
+    {
+        auto file = std::make_unique<QFile>(parser.value(replayOption));
+        if (!file->open(QIODevice::ReadOnly))
+        {
+            qWarning() << "Cannot open replay" << file->fileName();
+            return 1;
+        }
+        scene.startReplay(std::move(file));
+    }
+    else
+    {
+        if (parser.isSet(recordOption))
+        {
+            auto file = std::make_unique<QFile>(parser.value(recordOption));
+            if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                qWarning() << "Cannot open record file" << file->fileName();
+                return 1;
+            }
+            scene.startRecording(std::move(file));
+        }
+        scene.startGameLoop();
+    }
 
-    return QApplication::exec();
+    const int result = QApplication::exec();
+    const TextureManager::Stats stats = textures.stats();
+    qInfo() << "Textures:" << stats.textures << "resident," << (stats.residentBytes >> 20) << "MiB,"
+        << stats.duplicates << "duplicate files sharing a texture," << (stats.duplicateBytes >> 10) << "KiB saved,"
+        << stats.packed << "packed in" << (stats.packedBytes >> 10) << "KiB of" << (stats.unpackedBytes >> 10) << "KiB,"
+        << stats.expansions << "expansions";
+    return result;
 }
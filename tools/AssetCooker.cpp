@@ -0,0 +1,448 @@
+//
+// Created by root on 7/10/25.
+//
+// lucknight_cook: decodes every image under an asset directory once, trims its transparent border and writes
+// them into a single pack (see src/Managers/AssetPackFormat.h) the game maps at start up.
+//
+//     lucknight_cook [--lz4] <asset directory> <output pack>
+//     lucknight_cook --manifest <asset directory> <output manifest>
+//
+// The second form only lists the images and writes the manifest (see src/Managers/AssetManifestFormat.h) the
+// game lists directories and clips from, the build runs it on every asset change.
+// Run it from the directory the game runs from, so the paths in the pack match the ones the game asks for.
+//
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QFile>
+#include <QImage>
+
+#include "../src/Managers/AssetManifestFormat.h"
+#include "../src/Managers/AssetPackFormat.h"
+#include "../src/Render/SpriteTrim.h"
+#include "../src/Render/TextureAtlas.h"
+#include "../src/Utils/FileUtils.h"
+#include "../src/Utils/Hash128.h"
+
+#ifdef LUCKNIGHT_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+using namespace AssetPackFormat;
+
+namespace
+{
+    Hash128 pixelHash(const QImage& image)
+    {
+        const int32_t shape[] = {image.width(), image.height(), static_cast<int32_t>(image.format())};
+        Hash128 hash = Hash128::of(shape, sizeof(shape));
+        const auto rowBytes = static_cast<size_t>(image.width()) * image.depth() / 8;
+        for (int row = 0; row < image.height(); row++)
+        {
+            hash = Hash128::of(image.constScanLine(row), rowBytes, hash.low ^ hash.high);
+        }
+        return hash;
+    }
+
+    struct Cooker
+    {
+        QFile& out;
+        bool compress;
+        std::vector<DirectoryEntry> directories;
+        std::vector<FrameEntry> frames;
+        std::vector<RecordEntry> records;
+        std::string strings;
+        uint64_t rawBytes = 0;
+        // Frames stored once for several files
+        uint32_t duplicates = 0;
+
+        uint32_t addString(const std::string& value)
+        {
+            const auto offset = static_cast<uint32_t>(strings.size());
+            strings += value;
+            return offset;
+        }
+
+        bool pad()
+        {
+            const uint64_t target = align(static_cast<uint64_t>(out.pos()));
+            const QByteArray zeros(static_cast<qsizetype>(target - out.pos()), '\0');
+            return out.write(zeros) == zeros.size();
+        }
+
+        // Writes a premultiplied image as the next record, returns its index
+        uint32_t writeRecord(const QImage& image, const uint32_t flags)
+        {
+            const QImage pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            const auto rowBytes = static_cast<size_t>(pixels.width()) * bytesPerPixel;
+            QByteArray raw(static_cast<qsizetype>(rowBytes * pixels.height()), Qt::Uninitialized);
+            for (int row = 0; row < pixels.height(); row++)
+            {
+                std::memcpy(raw.data() + row * rowBytes, pixels.constScanLine(row), rowBytes);
+            }
+            rawBytes += raw.size();
+
+            RecordEntry record{
+                .width = static_cast<uint32_t>(pixels.width()),
+                .height = static_cast<uint32_t>(pixels.height()),
+                .compression = None,
+                .flags = flags
+            };
+            QByteArray stored = raw;
+#ifdef LUCKNIGHT_HAVE_LZ4
+            if (compress)
+            {
+                QByteArray packed(LZ4_compressBound(static_cast<int>(raw.size())), Qt::Uninitialized);
+                const int size = LZ4_compress_default(raw.constData(), packed.data(), static_cast<int>(raw.size()),
+                                                      static_cast<int>(packed.size()));
+                // Keep incompressible records raw, they can then be used straight from the mapping
+                if (size > 0 && size < raw.size())
+                {
+                    packed.truncate(size);
+                    stored = packed;
+                    record.compression = LZ4;
+                }
+            }
+#endif
+            if (!pad())
+            {
+                return UINT32_MAX;
+            }
+            record.offset = static_cast<uint64_t>(out.pos());
+            record.storedSize = static_cast<uint64_t>(stored.size());
+            if (out.write(stored) != stored.size())
+            {
+                return UINT32_MAX;
+            }
+            records.push_back(record);
+            return static_cast<uint32_t>(records.size() - 1);
+        }
+
+        bool cookDirectory(const std::string& name)
+        {
+            const std::vector<std::string> files = FileUtils::listImages(name);
+            std::vector<QImage> images;
+            std::vector<SpriteTrim::Trim> trims;
+            std::vector<std::string> paths;
+            for (const auto& file : files)
+            {
+                QImage image(QString::fromStdString(file));
+                if (image.isNull())
+                {
+                    qWarning() << "lucknight_cook: Cannot decode" << QString::fromStdString(file);
+                    continue;
+                }
+                trims.push_back(SpriteTrim::trim(image));
+                images.push_back(std::move(image));
+                paths.push_back(file);
+            }
+            if (images.empty())
+            {
+                return true;
+            }
+
+            // Repeated frames point at the pixels of their first occurrence, the game then shares one texture
+            std::vector<QImage> unique;
+            std::vector<size_t> source(images.size());
+            std::unordered_map<Hash128, size_t, Hash128::Hasher> firstWith;
+            for (size_t i = 0; i < images.size(); i++)
+            {
+                const auto [first, inserted] = firstWith.try_emplace(pixelHash(images[i]), unique.size());
+                if (inserted)
+                {
+                    unique.push_back(images[i]);
+                }
+                else
+                {
+                    duplicates++;
+                }
+                source[i] = first->second;
+            }
+
+            // Same packing the game does at run time, one atlas per directory
+            TextureAtlas atlas;
+            const auto regions = atlas.build(unique);
+            std::vector<uint32_t> ownRecords(unique.size(), UINT32_MAX);
+            std::vector<uint32_t> pageRecords(atlas.pageCount());
+            for (uint32_t page = 0; page < atlas.pageCount(); page++)
+            {
+                pageRecords[page] = writeRecord(atlas.page(page), RecordIsPage);
+                if (pageRecords[page] == UINT32_MAX)
+                {
+                    return false;
+                }
+            }
+
+            const std::string directory = name.back() == '/' ? name : name + '/';
+            directories.push_back(DirectoryEntry{
+                .nameOffset = addString(directory),
+                .nameLength = static_cast<uint32_t>(directory.size()),
+                .firstFrame = static_cast<uint32_t>(frames.size()),
+                .frameCount = static_cast<uint32_t>(images.size())
+            });
+            for (size_t i = 0; i < images.size(); i++)
+            {
+                FrameEntry frame{
+                    .pathOffset = addString(paths[i]),
+                    .pathLength = static_cast<uint32_t>(paths[i].size()),
+                    .width = static_cast<uint32_t>(images[i].width()),
+                    .height = static_cast<uint32_t>(images[i].height()),
+                    .canvasWidth = static_cast<uint32_t>(trims[i].canvas.width()),
+                    .canvasHeight = static_cast<uint32_t>(trims[i].canvas.height()),
+                    .trimX = static_cast<uint32_t>(trims[i].rect.x()),
+                    .trimY = static_cast<uint32_t>(trims[i].rect.y())
+                };
+                const TextureAtlas::Region& region = regions[source[i]];
+                if (region.page == TextureAtlas::noPage)
+                {
+                    uint32_t& record = ownRecords[source[i]];
+                    if (record == UINT32_MAX)
+                    {
+                        record = writeRecord(unique[source[i]], 0);
+                        if (record == UINT32_MAX)
+                        {
+                            return false;
+                        }
+                    }
+                    frame.record = record;
+                }
+                else
+                {
+                    frame.record = pageRecords[region.page];
+                    frame.x = static_cast<uint32_t>(region.rect.x());
+                    frame.y = static_cast<uint32_t>(region.rect.y());
+                }
+                frames.push_back(frame);
+            }
+            return true;
+        }
+
+        template<typename T>
+        bool writeTable(const std::vector<T>& table, uint64_t& offset)
+        {
+            if (!pad())
+            {
+                return false;
+            }
+            offset = static_cast<uint64_t>(out.pos());
+            const auto bytes = static_cast<qint64>(table.size() * sizeof(T));
+            return out.write(reinterpret_cast<const char*>(table.data()), bytes) == bytes;
+        }
+
+        bool finish()
+        {
+            Header header{
+                .magic = magic,
+                .version = version,
+                .directoryCount = static_cast<uint32_t>(directories.size()),
+                .frameCount = static_cast<uint32_t>(frames.size()),
+                .recordCount = static_cast<uint32_t>(records.size()),
+            };
+            if (!writeTable(directories, header.directoriesOffset) ||
+                !writeTable(frames, header.framesOffset) ||
+                !writeTable(records, header.recordsOffset) ||
+                !pad())
+            {
+                return false;
+            }
+            header.stringsOffset = static_cast<uint64_t>(out.pos());
+            header.stringsSize = strings.size();
+            if (out.write(strings.data(), static_cast<qint64>(strings.size())) != static_cast<qint64>(strings.size()))
+            {
+                return false;
+            }
+            return out.seek(0) && out.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+        }
+    };
+}
+
+namespace
+{
+    namespace Manifest = AssetManifestFormat;
+
+    struct ManifestWriter
+    {
+        std::vector<Manifest::DirectoryEntry> directories;
+        std::vector<Manifest::ClipEntry> clips;
+        std::vector<Manifest::FileEntry> files;
+        std::string strings;
+
+        uint32_t addString(const std::string& value)
+        {
+            const auto offset = static_cast<uint32_t>(strings.size());
+            strings += value;
+            return offset;
+        }
+
+        void addDirectory(const std::string& name)
+        {
+            const std::string directory = name.back() == '/' ? name : name + '/';
+            // Listed the way the game lists it, consecutive frames of a clip stay together
+            const std::vector<std::string> paths = FileUtils::listImages(directory);
+            if (paths.empty())
+            {
+                return;
+            }
+            const auto first = static_cast<uint32_t>(files.size());
+            directories.push_back(Manifest::DirectoryEntry{
+                .nameOffset = addString(directory),
+                .nameLength = static_cast<uint32_t>(directory.size()),
+                .firstFile = first,
+                .fileCount = static_cast<uint32_t>(paths.size())
+            });
+            std::string clip;
+            uint32_t clipStart = first;
+            const auto closeClip = [&]
+            {
+                const auto end = static_cast<uint32_t>(files.size());
+                if (!clip.empty() && end > clipStart)
+                {
+                    const std::string clipName = directory + clip;
+                    clips.push_back(Manifest::ClipEntry{
+                        .nameOffset = addString(clipName),
+                        .nameLength = static_cast<uint32_t>(clipName.size()),
+                        .firstFile = clipStart,
+                        .fileCount = end - clipStart
+                    });
+                }
+            };
+            for (const auto& path : paths)
+            {
+                std::string fileClip = FileUtils::clipFrame(path).clip;
+                if (fileClip != clip)
+                {
+                    closeClip();
+                    clip = std::move(fileClip);
+                    clipStart = static_cast<uint32_t>(files.size());
+                }
+                files.push_back(Manifest::FileEntry{
+                    .pathOffset = addString(path),
+                    .pathLength = static_cast<uint32_t>(path.size())
+                });
+            }
+            closeClip();
+        }
+
+        bool write(QFile& out) const
+        {
+            const Manifest::Header header{
+                .magic = Manifest::magic,
+                .version = Manifest::version,
+                .directoryCount = static_cast<uint32_t>(directories.size()),
+                .clipCount = static_cast<uint32_t>(clips.size()),
+                .fileCount = static_cast<uint32_t>(files.size()),
+                .stringsSize = static_cast<uint32_t>(strings.size()),
+            };
+            const auto writeBytes = [&out](const void* data, const size_t size)
+            {
+                return out.write(static_cast<const char*>(data), static_cast<qint64>(size)) ==
+                    static_cast<qint64>(size);
+            };
+            return writeBytes(&header, sizeof(header)) &&
+                writeBytes(directories.data(), directories.size() * sizeof(Manifest::DirectoryEntry)) &&
+                writeBytes(clips.data(), clips.size() * sizeof(Manifest::ClipEntry)) &&
+                writeBytes(files.data(), files.size() * sizeof(Manifest::FileEntry)) &&
+                writeBytes(strings.data(), strings.size());
+        }
+    };
+
+    // The asset directory and every directory below it, sorted
+    QStringList assetDirectories(QString root)
+    {
+        while (root.size() > 1 && root.endsWith('/'))
+        {
+            root.chop(1);
+        }
+        QStringList names{root};
+        QDirIterator it(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            names.push_back(it.next());
+        }
+        names.sort();
+        return names;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Cooks the game assets into a memory mapped pack.");
+    parser.addHelpOption();
+    const QCommandLineOption lz4Option("lz4", "Compress records with LZ4 where it helps.");
+    const QCommandLineOption manifestOption("manifest", "Write the asset manifest instead of a pack.");
+    parser.addOption(lz4Option);
+    parser.addOption(manifestOption);
+    parser.addPositionalArgument("assets", "Asset directory, as the game spells it (e.g. assets).");
+    parser.addPositionalArgument("output", "Output pack or manifest file.");
+    parser.process(app);
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 2)
+    {
+        parser.showHelp(1);
+    }
+
+    if (parser.isSet(manifestOption))
+    {
+        ManifestWriter manifest;
+        for (const QString& name : assetDirectories(arguments[0]))
+        {
+            manifest.addDirectory(name.toStdString());
+        }
+        QFile out(arguments[1]);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || !manifest.write(out))
+        {
+            qWarning() << "lucknight_cook: Failed writing" << out.fileName();
+            return 1;
+        }
+        qInfo().noquote() << QString("lucknight_cook: manifest of %1 directories, %2 clips, %3 files")
+                             .arg(manifest.directories.size()).arg(manifest.clips.size())
+                             .arg(manifest.files.size());
+        return 0;
+    }
+
+#ifndef LUCKNIGHT_HAVE_LZ4
+    if (parser.isSet(lz4Option))
+    {
+        qWarning() << "lucknight_cook: Built without LZ4, writing raw records";
+    }
+#endif
+
+    QFile out(arguments[1]);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "lucknight_cook: Cannot write" << out.fileName();
+        return 1;
+    }
+    // Header is rewritten once the tables are known
+    const Header placeholder{};
+    out.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+
+    Cooker cooker{.out = out, .compress = parser.isSet(lz4Option)};
+    for (const QString& name : assetDirectories(arguments[0]))
+    {
+        if (!cooker.cookDirectory(name.toStdString()))
+        {
+            qWarning() << "lucknight_cook: Failed writing" << out.fileName();
+            return 1;
+        }
+    }
+    if (!cooker.finish())
+    {
+        qWarning() << "lucknight_cook: Failed writing" << out.fileName();
+        return 1;
+    }
+
+    qInfo().noquote() << QString("lucknight_cook: %1 directories, %2 frames (%6 duplicates) in %3 records, "
+                                 "%4 MiB of pixels, pack %5 MiB")
+                         .arg(cooker.directories.size()).arg(cooker.frames.size()).arg(cooker.records.size())
+                         .arg(cooker.rawBytes / 1048576.0, 0, 'f', 1).arg(out.size() / 1048576.0, 0, 'f', 1)
+                         .arg(cooker.duplicates);
+    return 0;
+}
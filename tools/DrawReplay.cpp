@@ -0,0 +1,159 @@
+//
+// Created by root on 7/10/25.
+//
+// lucknight_replay_draws: loads a draw capture written by `lucknight --capture-draws` and pushes its frames
+// through the software renderer as fast as it can, so renderer changes can be measured on real frames
+// without running the simulation.
+//
+//     lucknight_replay_draws [--pack assets.pack] [--loops 10] [--size 1280x720] [--threads 4] [--out last.png] <capture>
+//
+// Run it from the directory the game runs from, path textures are loaded the same way the game loads them.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+
+#include "../src/Managers/TextureManager.h"
+#include "../src/Render/DrawStreamReader.h"
+#include "../src/Render/SoftwareRenderer.h"
+#include "../src/Type/Errors.h"
+
+namespace
+{
+    // Swallows the stream, measures what submission alone costs
+    class NullBackend final : public RenderBackend
+    {
+    public:
+        size_t draws = 0;
+        size_t runs = 0;
+
+        void draw(Texture&, const float*, const SpriteColor&) override
+        {
+            draws++;
+        }
+
+        void drawRun(Texture&, const float*, const SpriteColor*, const size_t count) override
+        {
+            draws += count;
+            runs++;
+        }
+    };
+
+    double millisecondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a captured draw stream through the software renderer.");
+    parser.addHelpOption();
+    const QCommandLineOption packOption("pack", "Load textures from the asset pack <file>.", "file");
+    const QCommandLineOption loopsOption("loops", "Replay the capture <n> times (default 10).", "n", "10");
+    const QCommandLineOption sizeOption("size", "Target size <width>x<height> (default 1280x720).", "size",
+                                        "1280x720");
+    const QCommandLineOption threadsOption("threads", "Rasterise on <n> threads (default 4).", "n", "4");
+    const QCommandLineOption outOption("out", "Save the last frame to <file>.", "file");
+    parser.addOption(packOption);
+    parser.addOption(loopsOption);
+    parser.addOption(sizeOption);
+    parser.addOption(threadsOption);
+    parser.addOption(outOption);
+    parser.addPositionalArgument("capture", "Draw capture file.");
+    parser.process(app);
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1)
+    {
+        parser.showHelp(1);
+    }
+    if (parser.isSet(packOption) && !TextureManager::getInstance().openPack(parser.value(packOption).toStdString()))
+    {
+        qWarning() << "lucknight_replay_draws: Cannot open pack" << parser.value(packOption);
+        return 1;
+    }
+    QFile file(arguments[0]);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "lucknight_replay_draws: Cannot open" << file.fileName();
+        return 1;
+    }
+
+    // Load everything first so file and texture loading stay out of the timings
+    std::vector<DrawStreamReader::Frame> frames;
+    std::unique_ptr<DrawStreamReader> reader;
+    try
+    {
+        reader = std::make_unique<DrawStreamReader>(&file);
+        DrawStreamReader::Frame frame;
+        while (reader->readFrame(frame))
+        {
+            frames.push_back(std::move(frame));
+        }
+    }
+    catch (const StreamFormatException& e)
+    {
+        qWarning() << "lucknight_replay_draws:" << e.what();
+        return 1;
+    }
+    if (frames.empty())
+    {
+        qWarning() << "lucknight_replay_draws: No frame in" << file.fileName();
+        return 1;
+    }
+
+    const QStringList size = parser.value(sizeOption).split('x');
+    const int width = std::max(1, size.value(0).toInt());
+    const int height = std::max(1, size.size() > 1 ? size.value(1).toInt() : 720);
+    const int loops = std::max(1, parser.value(loopsOption).toInt());
+    const int threads = std::max(1, parser.value(threadsOption).toInt());
+
+    NullBackend null;
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++)
+    {
+        for (const auto& frame : frames)
+        {
+            DrawStreamReader::replay(null, frame);
+        }
+    }
+    const double submit = millisecondsSince(start);
+
+    SoftwareRenderer renderer(width, height, frames.front().zoom, threads);
+    start = std::chrono::steady_clock::now();
+    double slowest = 0;
+    for (int loop = 0; loop < loops; loop++)
+    {
+        for (const auto& frame : frames)
+        {
+            const auto frameStart = std::chrono::steady_clock::now();
+            renderer.setZoom(frame.zoom);
+            renderer.begin();
+            DrawStreamReader::replay(renderer, frame);
+            renderer.end();
+            slowest = std::max(slowest, millisecondsSince(frameStart));
+        }
+    }
+    const double render = millisecondsSince(start);
+
+    const double frameCount = static_cast<double>(frames.size()) * loops;
+    qInfo().noquote() << QString("lucknight_replay_draws: %1 frames x %2 loops, %3 draws in %4 texture runs per frame")
+                         .arg(frames.size()).arg(loops).arg(static_cast<double>(null.draws) / frameCount, 0, 'f', 0)
+                         .arg(static_cast<double>(null.runs) / frameCount, 0, 'f', 0);
+    qInfo().noquote() << QString("  submission       %1 ms/frame").arg(submit / frameCount, 0, 'f', 3);
+    qInfo().noquote() << QString("  software render  %1 ms/frame, slowest %2 ms (%3x%4, %5 threads)")
+                         .arg(render / frameCount, 0, 'f', 3).arg(slowest, 0, 'f', 3)
+                         .arg(width).arg(height).arg(threads);
+    if (parser.isSet(outOption) && !renderer.image().save(parser.value(outOption)))
+    {
+        qWarning() << "lucknight_replay_draws: Cannot write" << parser.value(outOption);
+        return 1;
+    }
+    return 0;
+}